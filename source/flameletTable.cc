@@ -0,0 +1,315 @@
+/**
+ * @file flameletTable.cc
+ * Source file for class flameletTable
+ * @author Victoria B. Lansinger
+ */
+
+#include "flameletTable.h"
+#include <iostream>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+////////////////////////////////////////////////////////////////////////////////
+/*! generate function
+ *
+ *      Pre-processing: evaluates the soot sources on the grid and writes the
+ *      table file. The (Z, C) points are divided among threads, one per
+ *      model in models (separate objects of the same configuration, e.g.,
+ *      constructed and configured one after another). The gas state is
+ *      computed once per (Z, C) point; the soot variable grid is swept at
+ *      each.
+ *
+ *      @param fname     /input  table file name
+ *      @param models    /input  soot models, one per thread
+ *      @param gasState  /input  gas state on the manifold (thread safe)
+ *      @param Zgrid     /input  mixture fraction grid (increasing)
+ *      @param Cgrid     /input  progress variable grid (increasing)
+ *      @param Mgrid     /input  grid of each normalized soot variable (increasing)
+ *      @param p_Mref    /input  normalization of the soot variables
+ */
+
+void flameletTable::generate(const string &fname, vector<soot*> &models, const gasStateFunc &gasState,
+                             const vector<double> &Zgrid, const vector<double> &Cgrid,
+                             const vector<vector<double> > &Mgrid, const vector<double> &p_Mref) {
+
+    soot *st  = models[0];
+    int nsvar = st->nsvar;
+    if (Mgrid.size() != nsvar || p_Mref.size() != nsvar) {
+        cout << endl << "ERROR: flameletTable::generate: need one grid and one Mref per soot variable." << endl;
+        exit(0);
+    }
+
+    vector<vector<double> > p_axes;
+    p_axes.push_back(Zgrid);
+    p_axes.push_back(Cgrid);
+    for(int k=0; k<nsvar; k++)
+        p_axes.push_back(Mgrid[k]);
+
+    vector<int> p_isp = st->get_species_used();
+    int  nOut_p = nsvar + p_isp.size();
+    long nPts   = 1;
+    for(int a=0; a<p_axes.size(); a++)
+        nPts *= p_axes[a].size();
+    vector<double> out(nPts*nOut_p);
+
+    //---------- evaluate in parallel over (Z, C) points
+
+    int nth = models.size();
+    vector<thread> threads;
+    for(int t=1; t<nth; t++)
+        threads.push_back(thread(evalRange, models[t], cref(gasState), cref(p_axes), cref(p_Mref),
+                                 cref(p_isp), t, nth, ref(out)));
+    evalRange(models[0], gasState, p_axes, p_Mref, p_isp, 0, nth, out);
+    for(int t=0; t<threads.size(); t++)
+        threads[t].join();
+
+    //---------- write the file
+
+    ofstream ofile(fname.c_str(), ios::binary);
+    if (!ofile) {
+        cout << endl << "ERROR: flameletTable::generate: cannot write " << fname << endl;
+        exit(0);
+    }
+
+    string p_config = st->get_config_string();
+    int    ival;
+    ofile.write("SOOTFLT1", 8);
+    ival = version;                     ofile.write((char*)&ival, sizeof(int));
+    ival = p_config.size();             ofile.write((char*)&ival, sizeof(int));
+    ofile.write(p_config.c_str(), p_config.size());
+    ival = p_axes.size();               ofile.write((char*)&ival, sizeof(int));
+    for(int a=0; a<p_axes.size(); a++) {
+        ival = p_axes[a].size();        ofile.write((char*)&ival, sizeof(int));
+        ofile.write((char*)&p_axes[a][0], p_axes[a].size()*sizeof(double));
+    }
+    ofile.write((char*)&p_Mref[0], nsvar*sizeof(double));
+    ival = nOut_p;                      ofile.write((char*)&ival, sizeof(int));
+    ival = p_isp.size();                ofile.write((char*)&ival, sizeof(int));
+    ofile.write((char*)&p_isp[0], p_isp.size()*sizeof(int));
+    long pos = ofile.tellp();
+    char pad[8] = {0};
+    ofile.write(pad, (8 - pos%8)%8);    // align the data for the mapped doubles
+    ofile.write((char*)&out[0], out.size()*sizeof(double));
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! evalRange function
+ *
+ *      Evaluates the table entries of (Z, C) points i0, i0+di, ... with model st.
+ */
+
+void flameletTable::evalRange(soot *st, const gasStateFunc &gasState, const vector<vector<double> > &p_axes,
+                              const vector<double> &p_Mref, const vector<int> &p_isp,
+                              const int &i0, const int &di, vector<double> &out) {
+
+    int  nsvar = st->nsvar;
+    int  nC    = p_axes[1].size();
+    int  nZC   = p_axes[0].size()*nC;
+    int  nOut_p = nsvar + p_isp.size();
+    long nM    = 1;
+    for(int k=0; k<nsvar; k++)
+        nM *= p_axes[2+k].size();
+
+    double T, P, rho, MW, mu;
+    vector<double> y(st->gasSootSources.size());
+    vector<int>    im(nsvar);
+
+    for(int izc=i0; izc<nZC; izc+=di) {
+
+        gasState(p_axes[0][izc/nC], p_axes[1][izc%nC], T, P, rho, MW, mu, y);
+        st->set_gas_state_vars(T, P, rho, MW, mu, y);
+
+        for(long m=0; m<nM; m++) {
+            long r = m;                                 // soot variable indices, last fastest
+            for(int k=nsvar-1; k>=0; k--) {
+                im[k] = r % p_axes[2+k].size();
+                r    /= p_axes[2+k].size();
+            }
+            for(int k=0; k<nsvar; k++)
+                st->sootvar[k] = p_axes[2+k][im[k]]*p_Mref[k];
+            st->setSrc();
+
+            double *o = &out[(izc*nM + m)*nOut_p];
+            for(int k=0; k<nsvar; k++)
+                o[k] = st->src[k];
+            for(int i=0; i<p_isp.size(); i++)
+                o[nsvar+i] = st->gasSootSources[p_isp[i]];
+        }
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! open function
+ *
+ *      Maps a table file (read only, shared) and reads its header. Stops
+ *      with an error if the file is not a table of this version or was
+ *      generated for a different model configuration than st.
+ *
+ *      @param fname   /input  table file name
+ *      @param st      /input  soot model the table is used with
+ */
+
+void flameletTable::open(const string &fname, soot *st) {
+
+    close();
+
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    struct stat sb;
+    if (fd < 0 || fstat(fd, &sb) != 0) {
+        cout << endl << "ERROR: flameletTable: cannot open " << fname << endl;
+        exit(0);
+    }
+    mapSize = sb.st_size;
+    map     = mmap(0, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        map = 0;
+        cout << endl << "ERROR: flameletTable: cannot map " << fname << endl;
+        exit(0);
+    }
+
+    //---------- header
+
+    const char *p = (const char*)map;
+    int ival;
+    if (mapSize < 16 || memcmp(p, "SOOTFLT1", 8) != 0) {
+        cout << endl << "ERROR: flameletTable: " << fname << " is not a soot table." << endl;
+        exit(0);
+    }
+    p += 8;
+    memcpy(&ival, p, sizeof(int));  p += sizeof(int);
+    if (ival != version) {
+        cout << endl << "ERROR: flameletTable: " << fname << " has version " << ival << ", expected " << version << endl;
+        exit(0);
+    }
+    memcpy(&ival, p, sizeof(int));  p += sizeof(int);
+    config = string(p, ival);       p += ival;
+    if (config != st->get_config_string()) {
+        cout << endl << "ERROR: flameletTable: " << fname << " is stale: generated for" << endl
+             << "    " << config << endl << "but the model is" << endl
+             << "    " << st->get_config_string() << endl;
+        exit(0);
+    }
+
+    int nAxes;
+    memcpy(&nAxes, p, sizeof(int)); p += sizeof(int);
+    axes.resize(nAxes);
+    for(int a=0; a<nAxes; a++) {
+        memcpy(&ival, p, sizeof(int));  p += sizeof(int);
+        axes[a].resize(ival);
+        memcpy(&axes[a][0], p, ival*sizeof(double));  p += ival*sizeof(double);
+    }
+    Mref.resize(st->nsvar);
+    memcpy(&Mref[0], p, st->nsvar*sizeof(double));    p += st->nsvar*sizeof(double);
+    memcpy(&nOut, p, sizeof(int));  p += sizeof(int);
+    memcpy(&ival, p, sizeof(int));  p += sizeof(int);
+    isp.resize(ival);
+    memcpy(&isp[0], p, ival*sizeof(int));  p += ival*sizeof(int);
+    long pos = p - (const char*)map;
+    p += (8 - pos%8)%8;
+    data = (const double*)p;
+
+    stride.resize(nAxes);
+    stride[nAxes-1] = 1;
+    for(int a=nAxes-2; a>=0; a--)
+        stride[a] = stride[a+1]*axes[a+1].size();
+
+    if ((const char*)(data + stride[0]*axes[0].size()*nOut) > (const char*)map + mapSize) {
+        cout << endl << "ERROR: flameletTable: " << fname << " is truncated." << endl;
+        exit(0);
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! close function
+ *
+ *      Unmaps the table file.
+ */
+
+void flameletTable::close() {
+
+    if (map)
+        munmap(map, mapSize);
+    map  = 0;
+    data = 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! lookup function
+ *
+ *      Multilinear interpolation of the table at (Z, C, M); values outside
+ *      the grid are clamped to its ends. Sets src (nsvar) and gasSootSources
+ *      (all species; those not stored are zero).
+ *
+ *      @param Z               /input  mixture fraction
+ *      @param C               /input  progress variable
+ *      @param M               /input  soot variables (not normalized)
+ *      @param src             /output soot variable sources
+ *      @param gasSootSources  /output gas species sources
+ */
+
+void flameletTable::lookup(const double &Z, const double &C, const vector<double> &M,
+                           vector<double> &src, vector<double> &gasSootSources) const {
+
+    int nAxes = axes.size();
+    int nsvar = nAxes - 2;
+
+    //---------- cell and weight on each axis
+
+    vector<long>   i0(nAxes);
+    vector<double> w1(nAxes);
+    for(int a=0; a<nAxes; a++) {
+        const vector<double> &g = axes[a];
+        double xa = a == 0 ? Z : (a == 1 ? C : M[a-2]/Mref[a-2]);
+        if (g.size() == 1 || xa <= g[0]) {
+            i0[a] = 0;
+            w1[a] = 0.0;
+        }
+        else if (xa >= g.back()) {
+            i0[a] = g.size()-2;
+            w1[a] = 1.0;
+        }
+        else {
+            i0[a] = upper_bound(g.begin(), g.end(), xa) - g.begin() - 1;
+            w1[a] = (xa - g[i0[a]])/(g[i0[a]+1] - g[i0[a]]);
+        }
+    }
+
+    //---------- sum over the 2^nAxes corners
+
+    vector<double> f(nOut, 0.0);
+    for(int c=0; c<(1<<nAxes); c++) {
+        double wc  = 1.0;
+        long   idx = 0;
+        for(int a=0; a<nAxes; a++) {
+            int up = (c >> a) & 1;
+            if (up && axes[a].size() == 1) { wc = 0.0; break; }
+            wc  *= up ? w1[a] : 1.0-w1[a];
+            idx += (i0[a]+up)*stride[a];
+        }
+        if (wc == 0.0) continue;
+        const double *d = data + idx*nOut;
+        for(int i=0; i<nOut; i++)
+            f[i] += wc*d[i];
+    }
+
+    src.resize(nsvar);
+    for(int k=0; k<nsvar; k++)
+        src[k] = f[k];
+    fill(gasSootSources.begin(), gasSootSources.end(), 0.0);
+    for(int i=0; i<isp.size(); i++)
+        gasSootSources[isp[i]] = f[nsvar+i];
+
+}
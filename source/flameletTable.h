@@ -0,0 +1,94 @@
+/**
+ * @file flameletTable.h
+ * Header file for class flameletTable
+ */
+
+#pragma once
+
+#include "soot.h"
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing precomputed soot source tables on a flamelet /
+ *  progress variable manifold, stored in a memory-mappable binary file.
+ *
+ *  Axes: mixture fraction Z, progress variable C, and one axis per soot
+ *  variable in normalized form sootvar[k]/Mref[k]. Each grid point stores
+ *  src and the gasSootSources of the gas species used by the model.
+ *
+ *  generate (pre-processing) sweeps setSrc over the grid with one model
+ *  object per thread and writes the file. At run time, open maps the file
+ *  read-only and shared, so all processes on a node use the same physical
+ *  pages, and lookup does a multilinear interpolation. The file header holds
+ *  the model configuration (soot::get_config_string) and the grid, and
+ *  open stops with an error if the configuration does not match the model
+ *  (stale table).
+ *
+ *  File layout (native byte order): magic "SOOTFLT1", int version,
+ *  int len + config string, int nAxes, per axis (int n, n doubles), nsvar
+ *  doubles Mref, int nOut, int nSp + nSp species indices, padding to 8
+ *  bytes, then nOut doubles per grid point (last axis fastest).
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class flameletTable {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        /** gas state at (Z, C): sets T, P, rho, MW, mu, and y (all species).
+         *  Called from several threads by generate: must be thread safe.
+         */
+        typedef function<void(const double &Z, const double &C, double &T, double &P,
+                              double &rho, double &MW, double &mu, vector<double> &y)> gasStateFunc;
+
+        static const int        version = 1;            ///< file format version
+
+        string                  config;                 ///< model configuration of the table
+        vector<vector<double> > axes;                   ///< grid: Z, C, normalized soot variables
+        vector<double>          Mref;                   ///< normalization of the soot variables
+        vector<int>             isp;                    ///< gas species of the stored gas sources
+        int                     nOut;                   ///< stored values per grid point (nsvar + isp.size())
+
+    private:
+
+        void                   *map;                    ///< mapped file
+        size_t                  mapSize;                ///< size of the mapped file
+        const double           *data;                   ///< table data in the mapped file
+        vector<long int>        stride;                 ///< data stride of each axis (in grid points)
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        static void generate(const string &fname, vector<soot*> &models, const gasStateFunc &gasState,
+                             const vector<double> &Zgrid, const vector<double> &Cgrid,
+                             const vector<vector<double> > &Mgrid, const vector<double> &p_Mref);
+
+        void   open(const string &fname, soot *st);
+        void   close();
+        void   lookup(const double &Z, const double &C, const vector<double> &M,
+                      vector<double> &src, vector<double> &gasSootSources) const;
+
+    private:
+
+        static void evalRange(soot *st, const gasStateFunc &gasState, const vector<vector<double> > &p_axes,
+                              const vector<double> &p_Mref, const vector<int> &p_isp,
+                              const int &i0, const int &di, vector<double> &out);
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        flameletTable() : nOut(0), map(0), mapSize(0), data(0) {}
+
+        ~flameletTable() { close(); }
+
+};
@@ -6,10 +6,14 @@
  */
 
 #include "soot.h"
+#include "tableCache.h"
+#include "sootKernels.h"
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>  // find
+#include <sstream>
+#include <typeinfo>
 
 ////////////////////////////////////////////////////////////////////////////////
 // Static members
@@ -31,8 +35,40 @@ int                     soot::i_elem_c;
 int                     soot::i_elem_h;
 vector<int>             soot::i_pah;
 vector<int>             soot::nC_PAH;
+vector<double>          soot::m_pah;
+vector<double>          soot::wdot_pah_coef;
+int                     soot::nPAHclass = 0;
+vector<int>             soot::pah_class;
+vector<double>          soot::class_coef;
+vector<double>          soot::class_m;
+vector<double>          soot::class_nC;
 vector<double>          soot::MW_sp;
 vector<string>          soot::spNames;
+vector<table1D>         soot::rateTables(soot::n_rateFactors);
+vector<double>          soot::rateTableTols(soot::n_rateFactors, 0.0);
+constexpr double        soot::Tmin_rateTable;
+constexpr double        soot::Tmax_rateTable;
+constexpr double        soot::eps_c;
+
+const double            soot::rateParams[soot::n_rateFactors][3] = {  // A, b, E (K) for f = A*T^b*exp(-E/T)
+    { 0.1E5,         0.0,    21100.0             },     // rf_nuc_LL
+    { 0.63E4,        0.0,    21100.0             },     // rf_nuc_LIN
+    { 750.0,         0.0,    12100.0             },     // rf_grw_LIN
+    { 0.6E4,         0.0,    12100.0             },     // rf_grw_LL
+    { 0.1E5,         0.5,    19680.0             },     // rf_oxi_LL
+    { 1.085E4/1000, -0.5,    1.977824E4          },     // rf_oxi_Lee
+    { 1290.0*0.13,  -0.5,    0.0                 },     // rf_Neoh_OH
+    { 20.0,          0.0,    15098.0             },     // rf_NSC_kA
+    { 4.46E-3,       0.0,    7650.0              },     // rf_NSC_kB
+    { 1.51E5,        0.0,    48817.0             },     // rf_NSC_kT
+    { 21.3,          0.0,   -2063.0              },     // rf_NSC_kz
+    { 4.2E13/1000,   0.0,    13.0/1.9872036E-3   },     // rf_HACA_fR1 (E in kcal/mol / R)
+    { 3.9E12/1000,   0.0,    11.0/1.9872036E-3   },     // rf_HACA_rR1
+    { 1.0E10/1000,   0.734,  1.43/1.9872036E-3   },     // rf_HACA_fR2
+    { 3.68E8/1000,   1.139,  17.1/1.9872036E-3   },     // rf_HACA_rR2
+    { 8.00E7/1000,   1.56,   3.8/1.9872036E-3    },     // rf_HACA_fR4
+    { 2.2E12/1000,   0.0,    7.5/1.9872036E-3    }      // rf_HACA_fR5
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -63,6 +99,32 @@ soot::soot(const int  p_nsvar,
     growth_mech      = p_growth_mech;
     oxidation_mech   = p_oxidation_mech;
     coagulation_mech = p_coagulation_mech;
+    splitCoag        = false;
+    useRateTable     = false;
+    rateTableTol     = 0.0;
+    ipp_dimer        = 0;
+    useCoagRegimes   = false;
+    coagRegimeTol    = 0.0;
+    Kn_fm_Fuchs      = Kn_fm_Frenk = 1.0E300;
+    Kn_c_Fuchs       = Kn_c_Frenk  = 0.0;
+    scaleMoments     = true;
+    N_ref            = 1.0;
+    m_ref            = 1.0;
+    nPairs_fm        = 0;
+    nPairs_c         = 0;
+    nPairs_tr        = 0;
+    Ntol_active      = 0.0;
+    ytol_active      = 0.0;
+    nCells_inactive  = 0;
+    nCells_nucOnly   = 0;
+    nCells_full      = 0;
+    skipTol          = 0.0;
+    wdotD_cnd        = 0.0;
+    reset_skip_counts();
+    reset_realize_counts();
+    set_src_cache(false);
+    pp_kT            = 0.0;
+    pp_current       = false;
 
     sootvar = vector<double>(nsvar, 0.0);
     gasSootSources.resize(spNames.size());              
@@ -107,6 +169,7 @@ soot::soot(const int  p_nsvar,
     isp = (isp != spNames.size()) ? isp : -1;
     i_co = isp;    
 
+    i_pah.clear();                                      // static: shared by all soot objects
     for(int i=0; i<PAH_spNames.size(); i++) {
         i_pah.push_back( find(spNames.begin(), spNames.end(), PAH_spNames[i]) - spNames.begin() );
         if (i_pah[i] == spNames.size()) {
@@ -116,38 +179,1073 @@ soot::soot(const int  p_nsvar,
     }
     rPAH_rSoot_ncnd.resize(i_pah.size(), 0.0);
 
+    //-------------- per-species PAH constants for set_m_dimer
+    // wdot_i = gamma_i * sqrt(4*pi*kb*T)*(6/(pi*rhoSoot))^(2/3) * m_i^(1/6) * N_i^2, with N_i = rho*y_i*Na/MW_i
+
+    double preFac = sqrt(4*M_PI*kb)*pow(6/(M_PI*rhoSoot), 2.0/3.0);
+    m_pah.resize(i_pah.size());
+    wdot_pah_coef.resize(i_pah.size());
+    for(int i=0; i<i_pah.size(); i++) {
+        double m_ipah  = MW_sp[i_pah[i]]/Na;
+        double gamma_i = m_ipah > 153 ? 1.501E-11*pow(m_ipah,4) : 1.501E-11*pow(m_ipah,4) / 3.0;   // sticking coefficient
+        double NperRY  = Na/MW_sp[i_pah[i]];                     // N_i / (rho*y_i)
+        m_pah[i]         = m_ipah;
+        wdot_pah_coef[i] = gamma_i * preFac * pow(m_ipah, 1.0/6.0) * NperRY*NperRY;
+    }
+    DIMER   = 0.0;
+    m_dimer = 0.0;
+
+    rC2H2_rSoot_n  = rH2_rSoot_ncnd = 0.0;              // gas source ratios: set by the rate functions
+    rO2_rSoot_go   = rOH_rSoot_go   = rH_rSoot_go = 0.0;
+    rCO_rSoot_go   = rH2_rSoot_go   = rC2H2_rSoot_go = 0.0;
+    wdotD   = 0.0;
+    beta_DD = 0.0;
+
     //-------------- TO DO: test that the species present are sufficient for the desired soot mechanism
 
 }
 
 
 ////////////////////////////////////////////////////////////////////////////////
-/*! set_gas_state function
+/*! set_gas_state function
+ *
+ *      Sets gas state properties. These will be implied by functions in this
+ *         class that depend on the gas state.
+ *
+ *      @param T_p      /input (K)
+ *      @param P_p      /input (Pa)
+ *      @param rho_p    /input (gas density, kg/m3)
+ *      @param MW_p     /input (mean molecular weight, kg/kmol)
+ *      @param mu_p     /input (dynamic viscosity kg/m*s)
+ *      @param y_p      /input mass fractions
+ */
+
+void soot::set_gas_state_vars(const double   &T_p,
+                              const double   &P_p,
+                              const double   &rho_p,
+                              const double   &MW_p,
+                              const double   &mu_p,
+                              vector<double> &y_p){
+    T   = T_p;
+    P   = P_p;
+    rho = rho_p;
+    MW  = MW_p;
+    mu  = mu_p;
+    yi  = &y_p;
+
+    gasUnchanged   = false;                 // see srcFromCache
+    cacheRecording = false;
+    pp_current     = false;                 // see setParticleProps
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! advanceCoagulation function
+ *
+ *      Advances sootvar over dt for the coagulation-only sub-problem.
+ *      Used with operator splitting: call set_coag_splitting(true) so setSrc
+ *      omits coagulation, then integrate the other processes with src and
+ *      call this for the coagulation sub-step. Implemented by models that
+ *      have a closed-form solution (MONO, LOGN).
+ *
+ *      @param dt      /input  time step (s)
+ *      @param nIter   /input  number of self-consistent updates of the
+ *                             coagulation coefficient (0 = frozen)
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+void soot::advanceCoagulation(const double &dt, const int &nIter) {
+
+    cout << endl << "ERROR: advanceCoagulation is not available for this soot model." << endl;
+    exit(0);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_active_tolerances function
+ *
+ *      Sets the tolerances used by setSrc_cells to partition cells (see
+ *      getCellClass). The defaults (0, 0) only skip cells that have exactly
+ *      no particles and no precursors.
+ *
+ *      @param p_Ntol  /input  particle number density tolerance (#/m3)
+ *      @param p_ytol  /input  precursor (C2H2 or PAH) mass fraction tolerance
+ */
+
+void soot::set_active_tolerances(const double &p_Ntol, const double &p_ytol) {
+
+    Ntol_active = p_Ntol;
+    ytol_active = p_ytol;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getCellClass function
+ *
+ *      Classifies a cell from its soot variables and gas mass fractions:
+ *          cell_full:      particle number density > Ntol_active
+ *          cell_nucOnly:   no particles, but nucleation precursor mass fraction > ytol_active
+ *                          (C2H2 for LL and LIN nucleation, PAH species for PAH)
+ *          cell_inactive:  neither
+ *      Needs only comparisons, so it is cheap enough to run on every cell
+ *      every step.
+ *
+ *      @param M     /input soot variables of the cell
+ *      @param y_p   /input gas species mass fractions of the cell
+ */
+
+int soot::getCellClass(const vector<double> &M, const vector<double> &y_p) {
+
+    if (getNumberDensity(M) > Ntol_active)
+        return cell_full;
+
+    if (nucleation_mech == "LL" || nucleation_mech == "LIN") {
+        if (y_p[i_c2h2] > ytol_active)
+            return cell_nucOnly;
+    }
+    else if (nucleation_mech == "PAH") {
+        for(int i=0; i<i_pah.size(); i++)
+            if (y_p[i_pah[i]] > ytol_active)
+                return cell_nucOnly;
+    }
+
+    return cell_inactive;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getPredictedCost function
+ *
+ *      Returns a cheap estimate of the cost of setSrc_cells for one cell,
+ *      e.g., to weight cells in a domain decomposition. Units are about
+ *      0.1 microseconds (fit to timings of MONO, LOGN, QMOM, MOMIC at -O3 on
+ *      x86-64); use as relative weights. The estimate uses the cell class
+ *      (getCellClass), the mechanisms, the PAH species (or class) count,
+ *      and the model's getModelCost (moment inversion, downselection,
+ *      interpolation). It does not account for skipping, caching, or tables.
+ *
+ *      @param M     /input soot variables of the cell
+ *      @param y_p   /input gas species mass fractions of the cell
+ */
+
+double soot::getPredictedCost(const vector<double> &M, const vector<double> &y_p) {
+
+    int cls = getCellClass(M, y_p);
+    if (cls == cell_inactive)
+        return 1.0;
+
+    double c = nucleation_mech == "PAH" ? 4.0 + 0.5*(nPAHclass > 0 ? nPAHclass : i_pah.size()) : 3.0;
+    if (cls == cell_nucOnly)
+        return c;
+
+    c += growth_mech == "HACA" || oxidation_mech == "HACA" ? 5.0 : 2.0;
+    return c + getModelCost(M);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc_cells function
+ *
+ *      Batch version of set_gas_state_vars + setSrc over a set of cells.
+ *      A pre-pass (getCellClass) partitions the cells: inactive cells get
+ *      exact zero sources, nucleation-only cells get only the nucleation
+ *      sources (setSrc_nucOnly), and only the compacted list of full cells
+ *      (cells_full) goes through setSrc. Cell counts of each class are
+ *      accumulated in nCells_inactive, nCells_nucOnly, nCells_full.
+ *
+ *      @param T_cells               /input  temperature of each cell (K)
+ *      @param P_cells               /input  pressure (Pa)
+ *      @param rho_cells             /input  density (kg/m3)
+ *      @param MW_cells              /input  mean molecular weight (kg/kmol)
+ *      @param mu_cells              /input  viscosity (kg/m*s)
+ *      @param y_cells               /input  gas species mass fractions
+ *      @param sootvar_cells         /input  soot variables
+ *      @param src_cells             /output soot variable sources (resized as needed)
+ *      @param gasSootSources_cells  /output gas species sources (resized as needed)
+ */
+
+void soot::setSrc_cells(const vector<double> &T_cells,   const vector<double> &P_cells,
+                        const vector<double> &rho_cells, const vector<double> &MW_cells,
+                        const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                        const vector<vector<double> > &sootvar_cells,
+                        vector<vector<double> > &src_cells,
+                        vector<vector<double> > &gasSootSources_cells) {
+
+    int nCells = T_cells.size();
+    src_cells.resize(nCells);
+    gasSootSources_cells.resize(nCells);
+
+    setSrc_range(0, nCells, T_cells, P_cells, rho_cells, MW_cells, mu_cells, y_cells,
+                 sootvar_cells, src_cells, gasSootSources_cells);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc_range function
+ *
+ *      setSrc_cells for cells ic0 to ic1-1 only; the cell arrays are not
+ *      resized (src_cells and gasSootSources_cells must have all cells).
+ *      Used by drivers that split a batch (e.g., sootBatch threads).
+ *
+ *      @param ic0   /input  first cell
+ *      @param ic1   /input  one past the last cell
+ *      (others as in setSrc_cells)
+ */
+
+void soot::setSrc_range(const int &ic0, const int &ic1,
+                        const vector<double> &T_cells,   const vector<double> &P_cells,
+                        const vector<double> &rho_cells, const vector<double> &MW_cells,
+                        const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                        const vector<vector<double> > &sootvar_cells,
+                        vector<vector<double> > &src_cells,
+                        vector<vector<double> > &gasSootSources_cells) {
+
+    //---------- partition the cells
+
+    cells_nucOnly.clear();
+    cells_full.clear();
+    for(int ic=ic0; ic<ic1; ic++) {
+        switch (getCellClass(sootvar_cells[ic], y_cells[ic])) {
+            case cell_full:    cells_full.push_back(ic);    break;
+            case cell_nucOnly: cells_nucOnly.push_back(ic); break;
+            default:
+                src_cells[ic].assign(nsvar, 0.0);
+                gasSootSources_cells[ic].assign(gasSootSources.size(), 0.0);
+        }
+    }
+    nCells_inactive += ic1 - ic0 - cells_nucOnly.size() - cells_full.size();
+    nCells_nucOnly  += cells_nucOnly.size();
+    nCells_full     += cells_full.size();
+
+    //---------- nucleation only
+
+    for(int j=0; j<cells_nucOnly.size(); j++) {
+        int ic = cells_nucOnly[j];
+        set_gas_state_vars(T_cells[ic], P_cells[ic], rho_cells[ic], MW_cells[ic], mu_cells[ic], y_cells[ic]);
+        sootvar.assign(nsvar, 0.0);
+        setSrc_nucOnly();
+        src_cells[ic]            = src;
+        gasSootSources_cells[ic] = gasSootSources;
+    }
+
+    //---------- full model
+
+    for(int j=0; j<cells_full.size(); j++) {
+        int ic = cells_full[j];
+        set_gas_state_vars(T_cells[ic], P_cells[ic], rho_cells[ic], MW_cells[ic], mu_cells[ic], y_cells[ic]);
+        sootvar = sootvar_cells[ic];
+        setSrc();
+        src_cells[ic]            = src;
+        gasSootSources_cells[ic] = gasSootSources;
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc_nucOnly function
+ *
+ *      Sets src and gasSootSources for a cell with no particles: only
+ *      nucleation contributes (no growth, oxidation, condensation, or
+ *      coagulation). Moment models: src[k] = m_nuc^k * Jnuc.
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+void soot::setSrc_nucOnly() {
+
+    double Jnuc  = getNucleationRate();                 // no particles: empty mi, wi
+    double m_nuc = Cmin*MW_c/Na;                        // after nucleation (PAH resets Cmin)
+
+    double mk = 1.0;
+    for (int k=0; k<nsvar; k++) {
+        src[k] = mk * Jnuc;                             // Nr = m_min^r * Jnuc
+        mk    *= m_nuc;
+    }
+
+    set_gasSootSources(Jnuc*m_nuc, 0.0, 0.0, 0.0);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! get_species_used function
+ *
+ *      Returns the indices of the gas species that the soot rates depend on
+ *      or act on (C2H2, O2, H, H2, OH, H2O, CO, and the PAH species);
+ *      species not in the mechanism are left out.
+ */
+
+vector<int> soot::get_species_used() {
+
+    int isp[7] = {i_c2h2, i_o2, i_h, i_h2, i_oh, i_h2o, i_co};
+
+    vector<int> sp;
+    for(int i=0; i<7; i++)
+        if (isp[i] >= 0 && find(sp.begin(), sp.end(), isp[i]) == sp.end())
+            sp.push_back(isp[i]);
+    for(int i=0; i<i_pah.size(); i++)
+        if (find(sp.begin(), sp.end(), i_pah[i]) == sp.end())
+            sp.push_back(i_pah[i]);
+    return sp;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! reset_counters function
+ *
+ *      Zeroes every work counter (cell classes, skips, coagulation pairs
+ *      and regimes, the re-evaluation cache, realizability).
+ */
+
+void soot::reset_counters() {
+
+    nCells_inactive = nCells_nucOnly = nCells_full = 0;
+    nCache_hit      = nCache_gasHit  = nCache_miss = 0;
+    reset_skip_counts();
+    reset_coag_regime_counts();
+    reset_realize_counts();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! addCounters function
+ *
+ *      Moves the work counters of s (a copy of this model, e.g., one per
+ *      thread) to this object: adds them here (realize_maxCorr: the max)
+ *      and zeroes them in s. Models with their own counters extend it.
+ *
+ *      @param s   /inout  model whose counters are moved
+ */
+
+void soot::addCounters(soot *s) {
+
+    nCells_inactive    += s->nCells_inactive;
+    nCells_nucOnly     += s->nCells_nucOnly;
+    nCells_full        += s->nCells_full;
+    nSkip_grw          += s->nSkip_grw;
+    nSkip_oxi          += s->nSkip_oxi;
+    nSkip_cnd          += s->nSkip_cnd;
+    nSkip_coagPairs    += s->nSkip_coagPairs;
+    nCoagPairs         += s->nCoagPairs;
+    nPairs_fm          += s->nPairs_fm;
+    nPairs_c           += s->nPairs_c;
+    nPairs_tr          += s->nPairs_tr;
+    nCache_hit         += s->nCache_hit;
+    nCache_gasHit      += s->nCache_gasHit;
+    nCache_miss        += s->nCache_miss;
+    nRealize_checked   += s->nRealize_checked;
+    nRealize_projected += s->nRealize_projected;
+    realize_maxCorr     = max(realize_maxCorr, s->realize_maxCorr);
+
+    s->reset_counters();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! get_config_string function
+ *
+ *      Returns a text description of the model configuration: model class,
+ *      nsvar, mechanism flags, rhoSoot, Cmin, sootMath accuracy, moment
+ *      scaling, the options that change src (coagulation splitting, skip
+ *      tolerance, coagulation regimes, rate tables, PAH lumping with its
+ *      class parameters), and the gas species used by
+ *      soot with their MW. Used to detect stale precomputed tables.
+ */
+
+string soot::get_config_string() {
+
+    ostringstream ss;
+    ss.precision(17);
+    ss << "model=" << typeid(*this).name() << ";nsvar=" << nsvar
+       << ";nuc=" << nucleation_mech << ";grw=" << growth_mech
+       << ";oxi=" << oxidation_mech << ";coa=" << coagulation_mech
+       << ";rhoSoot=" << rhoSoot
+       << ";Cmin=" << (nucleation_mech == "PAH" ? 0.0 : Cmin)    // PAH resets Cmin from the gas
+       << ";math=" << sootMath::get_accuracy()
+       << ";scaled=" << scaleMoments
+       << ";splitCoag=" << splitCoag << ";skipTol=" << skipTol
+       << ";regimes=" << useCoagRegimes << ":" << (useCoagRegimes ? coagRegimeTol : 0.0)
+       << ";rateTable=" << useRateTable << ":" << rateTableTol
+       << ";nPAHclass=" << (nucleation_mech == "PAH" ? nPAHclass : 0);
+    if (nucleation_mech == "PAH" && nPAHclass > 0) {
+        ss << ";pahClass=";
+        for(int i=0; i<pah_class.size(); i++)
+            ss << pah_class[i] << ",";
+        ss << ";classes=";
+        for(int c=0; c<nPAHclass; c++)
+            ss << class_coef[c] << ":" << class_m[c] << ":" << class_nC[c] << ",";
+    }
+    ss << ";sp=";
+    vector<int> sp = get_species_used();
+    for(int i=0; i<sp.size(); i++)
+        ss << sp[i] << ":" << MW_sp[sp[i]] << ",";
+    return ss.str();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_src_cache function
+ *
+ *      Turns the re-evaluation cache on or off (clearing it). When on, each
+ *      model's setSrc compares its inputs with those of its last evaluation:
+ *          - gas state and sootvar unchanged: src and gasSootSources are
+ *            restored from the cache (nCache_hit);
+ *          - only sootvar changed: the gas-only rate pieces are reused
+ *            (nucleation rate for LL/LIN, dimer production for PAH, growth
+ *            rate for LIN, oxidation rates for LL/LEE_NEOH/NSC_NEOH) and the
+ *            rest is recomputed (nCache_gasHit);
+ *          - otherwise everything is recomputed (nCache_miss).
+ *      Inputs are unchanged if equal to within p_cacheTol (relative).
+ *      Turn on after the other options (tables, lumping, skipping) are set.
+ *
+ *      @param p_useSrcCache  /input  use the cache
+ *      @param p_cacheTol     /input  relative tolerance on the inputs
+ */
+
+void soot::set_src_cache(const bool &p_useSrcCache, const double &p_cacheTol) {
+
+    useSrcCache     = p_useSrcCache;
+    cacheTol        = p_cacheTol;
+    gasUnchanged    = false;
+    cacheRecording  = false;
+    cacheHave_nuc   = cacheHave_grw = cacheHave_oxi = cacheHave_dimer = false;
+    cacheJnuc       = cacheKgrw = cacheKoxi = 0.0;
+    nCache_hit      = nCache_gasHit = nCache_miss = 0;
+    cacheGas.clear();
+    cacheSoot.clear();
+    cacheSrc.clear();
+    cacheGasSrc.clear();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! srcFromCache function
+ *
+ *      Called at the start of each model's setSrc (see set_src_cache).
+ *      Returns true if src and gasSootSources were restored from the cache,
+ *      so setSrc can return. Otherwise records the current inputs and sets
+ *      gasUnchanged for reuse of the gas-only rates; call saveSrcCache at
+ *      the end of setSrc.
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+bool soot::srcFromCache() {
+
+    if (!useSrcCache)
+        return false;
+
+    int nsp = yi->size();
+    double gas[5] = {T, P, rho, MW, mu};
+
+    //---------- compare with the inputs of the last evaluation
+
+    bool same = (cacheGas.size() == 5+nsp);
+    for(int i=0; same && i<5; i++)
+        same = abs(gas[i]-cacheGas[i]) <= cacheTol*max(abs(gas[i]), abs(cacheGas[i]));
+    for(int i=0; same && i<nsp; i++)
+        same = abs((*yi)[i]-cacheGas[5+i]) <= cacheTol*max(abs((*yi)[i]), abs(cacheGas[5+i]));
+    gasUnchanged = same;
+
+    for(int k=0; same && k<nsvar; k++)
+        same = abs(sootvar[k]-cacheSoot[k]) <= cacheTol*max(abs(sootvar[k]), abs(cacheSoot[k]));
+
+    if (same && cacheSrc.size() == nsvar) {
+        nCache_hit++;
+        src            = cacheSrc;
+        gasSootSources = cacheGasSrc;
+        return true;
+    }
+
+    //---------- record the inputs of this evaluation
+
+    if (gasUnchanged)
+        nCache_gasHit++;
+    else {
+        nCache_miss++;
+        cacheGas.resize(5+nsp);
+        for(int i=0; i<5; i++)
+            cacheGas[i] = gas[i];
+        for(int i=0; i<nsp; i++)
+            cacheGas[5+i] = (*yi)[i];
+        cacheHave_nuc = cacheHave_grw = cacheHave_oxi = cacheHave_dimer = false;
+    }
+    cacheSoot = sootvar;
+    cacheSrc.clear();                       // until saveSrcCache
+    cacheRecording = true;                  // gas-only rates computed now belong to cacheGas
+
+    return false;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! saveSrcCache function
+ *
+ *      Called at the end of each model's setSrc: stores src and
+ *      gasSootSources for the inputs recorded by srcFromCache.
+ */
+
+void soot::saveSrcCache() {
+
+    if (!useSrcCache)
+        return;
+
+    cacheSrc       = src;
+    cacheGasSrc    = gasSootSources;
+    cacheRecording = false;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! negligible function
+ *
+ *      Relative tolerance test for skipping a process (see set_skip_tolerance):
+ *      true if the cheap estimate est of the process is at most skipTol times
+ *      the dominant term; then nSkip is incremented. Always false if skipTol = 0.
+ *
+ *      @param est       /input  estimate of the process magnitude
+ *      @param dominant  /input  magnitude of the dominant term (same units)
+ *      @param nSkip     /output skip counter to increment
+ */
+
+bool soot::negligible(const double &est, const double &dominant, long int &nSkip) {
+
+    if (skipTol > 0.0 && abs(est) <= skipTol*abs(dominant)) {
+        nSkip++;
+        return true;
+    }
+    return false;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! skipSurfaceProcess function
+ *
+ *      Growth and oxidation act on the same soot surface, so their ratio is
+ *      the ratio of the per-area rates. Both are estimated in kg/m2*s by
+ *      surfaceRateBound (each concentration times its T-only rate factor).
+ *      The requested process is skipped (e.g., oxidation on the rich side)
+ *      only if an upper bound of it is below skipTol times a lower bound of
+ *      the other one, so skipTol bounds the fraction of the surface rate
+ *      that is dropped. Never skips when both are not enabled or when
+ *      either is HACA (its rates are not a rate factor times a concentration).
+ *
+ *      @param growth  /input  true for growth, false for oxidation
+ *      @param M0      /input  moment 0 (#/m3), as passed to getGrowthRate
+ *      @param M1      /input  moment 1 (kg-soot/m3), as passed to getGrowthRate
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+bool soot::skipSurfaceProcess(const bool &growth, const double &M0, const double &M1) {
+
+    if (skipTol <= 0.0 || growth_mech == "NONE" || oxidation_mech == "NONE" ||
+        growth_mech == "HACA" || oxidation_mech == "HACA")
+        return false;
+
+    double Kskip = surfaceRateBound( growth, true,  M0, M1);     // kg/m2*s
+    double Kdom  = surfaceRateBound(!growth, false, M0, M1);     // kg/m2*s
+
+    return Kskip <= skipTol*Kdom;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! surfaceRateBound function
+ *
+ *      Bound of the growth or oxidation rate (kg/m2*s) for skipSurfaceProcess,
+ *      without the side effects of the rate functions. LIN, LL, and LEE_NEOH
+ *      are a rate factor times a concentration (times the LL surface term),
+ *      so the bound is the rate itself. The NSC rate of NSC_NEOH is a mix
+ *      (0 <= x <= 1) of kA*pO2/(1+kz*pO2) and kB*pO2, so the min or max of
+ *      the two bounds it without kT and the x fraction.
+ *
+ *      @param growth  /input  true for growth, false for oxidation
+ *      @param upper   /input  true for an upper bound, false for a lower bound
+ *      @param M0      /input  moment 0 (#/m3)
+ *      @param M1      /input  moment 1 (kg-soot/m3)
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+double soot::surfaceRateBound(const bool &growth, const bool &upper, const double &M0, const double &M1) {
+
+    if (growth) {
+        double cC2H2 = i_c2h2 >= 0 ? rho * (*yi)[i_c2h2] / MW_sp[i_c2h2] : 0.0;      // kmol/m3
+        if (growth_mech == "LIN")
+            return getRateFactor(rf_grw_LIN) * cC2H2 * 2.0*MW_c;
+        double Am2m3 = 0.0;                                                       // as in growth_LL
+        if (M0 > 0.0)
+            Am2m3 = M_PI * sootMath::pow23(abs(6/(M_PI*rhoSoot)*M1/M0)) * abs(M0);
+        return Am2m3 > 0 ? getRateFactor(rf_grw_LL) * cC2H2/sqrt(Am2m3) * 2.0*MW_c : 0.0;
+    }
+
+    if (oxidation_mech == "LL") {
+        double cO2 = i_o2 >= 0 ? rho * (*yi)[i_o2] / MW_sp[i_o2] : 0.0;           // kmol/m3
+        return getRateFactor(rf_oxi_LL) * cO2 * MW_c;
+    }
+
+    double pO2 = i_o2 >= 0 ? (*yi)[i_o2] * MW / MW_sp[i_o2] * P / 101325.0 : 0.0;   // atm
+    double pOH = i_oh >= 0 ? (*yi)[i_oh] * MW / MW_sp[i_oh] * P / 101325.0 : 0.0;
+    double rOH = getRateFactor(rf_Neoh_OH)*pOH;
+
+    if (oxidation_mech == "LEE_NEOH")
+        return getRateFactor(rf_oxi_Lee)*pO2 + rOH;
+
+    double kA = getRateFactor(rf_NSC_kA);                                         // NSC_NEOH
+    double kB = getRateFactor(rf_NSC_kB);
+    double kz = getRateFactor(rf_NSC_kz);
+    double k  = upper ? max(kA/(1.0+kz*pO2), kB) : min(kA/(1.0+kz*pO2), kB);
+    return k*pO2*rhoSoot + rOH;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_rate_table function
+ *
+ *      Turns tabulation of the T-only rate factors on or off. When turned on,
+ *      the factors used by the selected nucleation, growth, and oxidation
+ *      mechanisms are tabulated vs 1/T on [Tmin_rateTable, Tmax_rateTable]
+ *      (cubic interpolation; uniform in 1/T so Arrhenius terms vary evenly).
+ *      Tables are shared by all soot objects; each is built once, and
+ *      rebuilt if a later call asks for a tighter relTol than it was built
+ *      with (call before other objects or threads use the tables).
+ *      Outside the table range the exact expressions are used.
+ *      Returns the largest relative interpolation error of the tables used.
+ *
+ *      @param p_useRateTable  /input  use tables (true) or exact expressions
+ *      @param relTol          /input  relative error tolerance of the tables
+ */
+
+double soot::set_rate_table(const bool &p_useRateTable, const double &relTol) {
+
+    useRateTable = p_useRateTable;
+    rateTableTol = useRateTable ? relTol : 0.0;
+    if (!useRateTable)
+        return 0.0;
+
+    vector<int> rf;
+    if (nucleation_mech == "LL")          rf.push_back(rf_nuc_LL);
+    if (nucleation_mech == "LIN")         rf.push_back(rf_nuc_LIN);
+    if (growth_mech     == "LIN")         rf.push_back(rf_grw_LIN);
+    if (growth_mech     == "LL")          rf.push_back(rf_grw_LL);
+    if (oxidation_mech  == "LL")          rf.push_back(rf_oxi_LL);
+    if (oxidation_mech  == "LEE_NEOH")  { rf.push_back(rf_oxi_Lee); rf.push_back(rf_Neoh_OH); }
+    if (oxidation_mech  == "NSC_NEOH")  { rf.push_back(rf_NSC_kA);  rf.push_back(rf_NSC_kB);
+                                          rf.push_back(rf_NSC_kT);  rf.push_back(rf_NSC_kz);
+                                          rf.push_back(rf_Neoh_OH); }
+    if (growth_mech == "HACA" || oxidation_mech == "HACA") {
+        rf.push_back(rf_HACA_fR1); rf.push_back(rf_HACA_rR1); rf.push_back(rf_HACA_fR2);
+        rf.push_back(rf_HACA_rR2); rf.push_back(rf_HACA_fR4); rf.push_back(rf_HACA_fR5);
+        rf.push_back(rf_Neoh_OH);
+    }
+
+    double err = 0.0;
+    for (int j=0; j<rf.size(); j++) {
+        int i = rf[j];
+        if (rateTables[i].n == 0 || relTol < rateTableTols[i]) {
+            ostringstream key;                  // the factor's coefficients (see set_table_cache)
+            key.precision(17);
+            key << "rateFactorExact.v" << rateTableVersion << ";rateFactor=" << i << ";A=" << rateParams[i][0] << ";b=" << rateParams[i][1]
+                << ";E=" << rateParams[i][2];
+            rateTables[i].initCached("rateTable", key.str(),
+                                     [i](double x) { return rateFactorExact(i, 1.0/x); },
+                                     1.0/Tmax_rateTable, 1.0/Tmin_rateTable, relTol);
+            rateTableTols[i] = relTol;
+        }
+        err = max(err, rateTables[i].err);
+    }
+
+    return err;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getRateFactor function
+ *
+ *      Returns rate factor i (see rateParams) at the current T, from the
+ *      table if set_rate_table(true) was called and T is in range. Without
+ *      the table, the factor is evaluated at the sootMath accuracy level
+ *      (the tables themselves are always built with rateFactorExact).
+ *
+ *      @param i    /input  rate factor index (rateFactors)
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+double soot::getRateFactor(const int &i) {
+
+    if (useRateTable) {
+        double x = 1.0/T;
+        if (rateTables[i].n > 0 && rateTables[i].inRange(x))
+            return rateTables[i](x);
+    }
+    if (sootMath::level == sootMath::acc_full)
+        return rateFactorExact(i, T);
+
+    const double &A = rateParams[i][0];
+    const double &b = rateParams[i][1];
+    const double &E = rateParams[i][2];
+    double Tb = b == 0.0 ? 1.0 : b == 0.5 ? sqrt(T) : b == -0.5 ? 1.0/sqrt(T) : sootMath::pow(T, b);
+    return E == 0.0 ? A*Tb : A*Tb*sootMath::exp(-E/T);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! rateFactorExact function
+ *
+ *      Returns rate factor i: A*T^b*exp(-E/T).
+ *
+ *      @param i    /input  rate factor index (rateFactors)
+ *      @param T_p  /input  temperature (K)
+ */
+
+double soot::rateFactorExact(const int &i, const double &T_p) {
+
+    const double &A = rateParams[i][0];
+    const double &b = rateParams[i][1];
+    const double &E = rateParams[i][2];
+
+    double Tb = b == 0.0 ? 1.0 : b == 0.5 ? sqrt(T_p) : b == -0.5 ? 1.0/sqrt(T_p) : pow(T_p, b);
+
+    return E == 0.0 ? A*Tb : A*Tb*exp(-E/T_p);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_table_cache function
+ *
+ *      Sets the directory of the persistent table cache (see tableCache);
+ *      "" turns caching off. Tables built later (set_rate_table,
+ *      soot_LOGN::set_coag_table) are loaded from the cache (memory
+ *      mapped, shared by all processes on a node) or built and saved.
+ *      Each table is keyed by everything it depends on (e.g., the
+ *      Arrhenius coefficients of a rate factor, table range, tolerance,
+ *      and the version of the code that builds it), so a changed
+ *      configuration or builder regenerates only the tables that actually
+ *      differ.
+ *
+ *      @param p_dir   /input  cache directory (must exist)
+ */
+
+void soot::set_table_cache(const string &p_dir) {
+
+    tableCache::dir = p_dir;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_coag_regimes function
+ *
+ *      Turns the regime-aware Fuchs and Frenklach kernels on or off. When on,
+ *      a pair whose particles both have Kn >= Kn_fm uses only the
+ *      free-molecular form, and a pair with both Kn <= Kn_c uses only the
+ *      continuum form (with slip correction); other pairs use the full form.
+ *      nPairs_fm, nPairs_c, nPairs_tr count the kernel calls on each path.
+ *
+ *      Kn here is the particle Knudsen number l/Dp (l = 8*D/(pi*c), the
+ *      particle mean free path of Fuchs): for equal particles both kernels
+ *      depend on the gas state only through it, unlike the gas Knudsen
+ *      number 2*mfp_g/Dp. Each kernel has its own thresholds, set from
+ *      p_tol by coagRegimeThreshold so that the asymptotic form is within
+ *      p_tol of the full form for any pair meeting them. The dimer kernels
+ *      are Frenklach's and use its thresholds. Frenklach's harmonic mean
+ *      approaches its limits more slowly, so its thresholds are wider; at
+ *      p_tol = 1E-3:
+ *          Fuchs:      Kn_fm = 22,  Kn_c = 0.0037
+ *          Frenklach:  Kn_fm = 990, Kn_c = 0.00099
+ *      Checked over pairs from 1E-27 to 1E-12 kg at 1000 to 2500 K and
+ *      mu = 3.5E-5 to 7E-5 Pa*s: the error stays below p_tol.
+ *
+ *      @param p_useCoagRegimes  /input  use the regime-aware kernels
+ *      @param p_tol             /input  relative error allowed for the asymptotic forms
+ */
+
+void soot::set_coag_regimes(const bool &p_useCoagRegimes, const double &p_tol) {
+
+    useCoagRegimes = p_useCoagRegimes;
+    if (useCoagRegimes && p_tol != coagRegimeTol) {
+        coagRegimeTol = p_tol;
+        Kn_fm_Fuchs   = coagRegimeThreshold(false, true,  p_tol);
+        Kn_c_Fuchs    = coagRegimeThreshold(false, false, p_tol);
+        Kn_fm_Frenk   = coagRegimeThreshold(true,  true,  p_tol);
+        Kn_c_Frenk    = coagRegimeThreshold(true,  false, p_tol);
+    }
+    reset_coag_regime_counts();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! coagRegimeError function
+ *
+ *      Largest relative error of the free-molecular (fm) or continuum (!fm)
+ *      form of the Fuchs or Frenklach (frenk) kernel vs the full form, for
+ *      a particle of diameter Dp paired with particles further into that
+ *      limit (diameters Dp down to Dp/1000 for fm, Dp up to 1000*Dp for the
+ *      continuum), in a reference flame gas (1500 K, 1 atm, air:
+ *      MW = 28.96, mu = 5.4E-5 Pa*s). Same formulas as the kernels.
+ *
+ *      @param frenk   /input  true for Frenklach, false for Fuchs
+ *      @param fm      /input  true for the free-molecular form, false for continuum
+ *      @param Dp      /input  diameter of the particle nearest the transition (m)
+ *      @param Kn      /output its particle Knudsen number l/Dp
+ */
+
+double soot::coagRegimeError(const bool &frenk, const bool &fm, const double &Dp, double &Kn) {
+
+    const double T_r  = 1500.0;
+    const double P_r  = 101325.0;
+    const double MW_r = 28.96;
+    const double mu_r = 5.4E-5;
+    double rho_r = P_r*MW_r/(Rg*T_r);
+    double mfp   = mu_r/rho_r*sqrt(M_PI*MW_r/(2.0*Rg*T_r));
+    double kT    = kb*T_r;
+
+    double m[2], Cc[2], D[2], c[2], g[2], d[2];
+    double err = 0.0;
+
+    for (int k=0; k<=24; k++) {
+        d[0] = Dp;
+        d[1] = Dp*pow(10.0, (fm ? -k : k)/8.0);
+        for (int p=0; p<2; p++) {
+            m[p]  = M_PI/6.0*rhoSoot*d[p]*d[p]*d[p];
+            Cc[p] = cunningham(2.0*mfp/d[p]);
+            D[p]  = kT*Cc[p]/(3.0*M_PI*mu_r*d[p]);
+            c[p]  = sqrt(8.0*kT/M_PI/m[p]);
+            double l = 8.0*D[p]/M_PI/c[p];
+            double q = d[p]*d[p] + l*l;
+            if (p == 0)
+                Kn = l/d[p];
+            g[p]  = sqrt(2.0)/3.0/d[p]/l*( pow(d[p]+l, 3.0) - q*sqrt(q) ) - sqrt(2.0)*d[p];
+        }
+        double Dp12 = d[0] + d[1];
+        double D12  = D[0] + D[1];
+        double c12  = sqrt(c[0]*c[0] + c[1]*c[1]);
+        double b_fm, b_c, b;
+        if (frenk) {
+            b_fm = eps_c*sqrt(M_PI*kT*0.5*(1.0/m[0] + 1.0/m[1])) * Dp12*Dp12;
+            b_c  = 2*kT/(3*mu_r)*(Cc[0]/d[0] + Cc[1]/d[1])*Dp12;
+            b    = b_fm*b_c/(b_fm + b_c);
+        }
+        else {
+            double g12 = sqrt(g[0]*g[0] + g[1]*g[1]);
+            b_fm = M_PI/4.0*eps_c*c12*Dp12*Dp12;
+            b_c  = 2.0*M_PI*D12*Dp12;
+            b    = 2.0*M_PI*D12*Dp12 / (Dp12/(Dp12+2.0*g12) + 8.0/eps_c*D12/c12/Dp12);
+        }
+        err = max(err, abs((fm ? b_fm : b_c)/b - 1.0));
+    }
+
+    return err;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! coagRegimeThreshold function
+ *
+ *      Particle Knudsen number (l/Dp) threshold at which the error of an
+ *      asymptotic kernel form (coagRegimeError) reaches tol, by bisection in
+ *      log(Dp) on [1E-10, 1E-2] m at the reference gas state. Returns 1E300
+ *      (fm) or 0 (continuum) if the form never meets tol on the interval.
+ *
+ *      @param frenk   /input  true for Frenklach, false for Fuchs
+ *      @param fm      /input  true for the free-molecular form, false for continuum
+ *      @param tol     /input  relative error allowed
+ */
+
+double soot::coagRegimeThreshold(const bool &frenk, const bool &fm, const double &tol) {
+
+    double lo = log(1.0E-10);                   // error falls with Dp for continuum, rises for fm
+    double hi = log(1.0E-2);
+    double Kn;
+    if (coagRegimeError(frenk, fm, exp(fm ? lo : hi), Kn) > tol)
+        return fm ? 1.0E300 : 0.0;
+
+    for (int it=0; it<60; it++) {
+        double mid = 0.5*(lo + hi);
+        if ((coagRegimeError(frenk, fm, exp(mid), Kn) <= tol) == fm)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    coagRegimeError(frenk, fm, exp(fm ? lo : hi), Kn);     // l/Dp of the threshold particle
+    return Kn;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_moment_scaling function
+ *
+ *      Turns the scaled moment representation on (default) or off. sootvar
+ *      and src hold raw moments M_k (kg^k/m3) either way; when on, QMOM
+ *      inverts the moments in reference units, M_k/(N_ref*m_ref^k) (see
+ *      setMomentScales), which are O(1) instead of spanning 1E16 to below
+ *      1E-70, and converts the weights and abscissas back at the end. MOMIC
+ *      needs no scaling (its interpolation of log(M_k/M_0) is exact for the
+ *      linear term k*log(m_ref)), so its results do not depend on this
+ *      flag. Off reproduces the raw-unit arithmetic.
+ *
+ *      @param p_scaleMoments  /input  use reference units
+ */
+
+void soot::set_moment_scaling(const bool &p_scaleMoments) {
+
+    scaleMoments = p_scaleMoments;
+    if (useSrcCache)
+        set_src_cache(true, cacheTol);                   // results change: drop cached sources
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setMomentScales function
+ *
+ *      Sets the reference units of a moment set: N_ref = M0 (#/m3) and
+ *      m_ref = M1/M0, the mean particle mass (kg), so the scaled M0 and M1
+ *      are 1. If M0 or M1 is not positive, N_ref = 1 and m_ref is the
+ *      nucleus mass Cmin*MW_c/Na.
+ *
+ *      @param M   /input  raw moments (kg^k/m3)
+ */
+
+void soot::setMomentScales(const vector<double> &M) {
+
+    bool ok = M.size() > 1 && M[0] > 0.0 && M[1] > 0.0;
+    N_ref = ok ? M[0]      : 1.0;
+    m_ref = ok ? M[1]/M[0] : Cmin*MW_c/Na;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! realizableMoments function
+ *
+ *      Realizability check and projection of a moment set on [0, inf), done
+ *      once per cell before the inversion (QMOM) or interpolation (MOMIC,
+ *      LOGN), so the model works at the highest realizable order directly
+ *      instead of downselecting by trial. The recurrence coefficients a_k,
+ *      b_k of the moments are found by the Chebyshev algorithm (on the
+ *      scaled moments, see setMomentScales), then the canonical zetas:
+ *          zeta_1 = a_0,  zeta_2k = b_k/zeta_(2k-1),  zeta_(2k+1) = a_k - zeta_2k
+ *      M_0..M_(N-1) is realizable iff zeta_1..zeta_(N-1) > 0. If zeta_j is
+ *      the first that is not, the set is projected onto the boundary of the
+ *      realizable set: zeta_j = 0 and the distribution ends there (a
+ *      quadrature of j/2 nodes, or (j+1)/2 with one at zero for odd j).
+ *      M_0..M_(j-1) are kept; the higher moments are replaced by those of
+ *      the quadrature. Returns j (N if realizable). M0 <= 0 or M1 <= 0 are
+ *      left to the models (returns 1 or 0, Mp = M).
+ *
+ *      Counts nRealize_checked and nRealize_projected; realize_maxCorr is the
+ *      largest relative change |Mp_k - M_k|/Mp_k of a projected moment.
+ *
+ *      @param M    /input   raw moments (kg^k/m3)
+ *      @param Mp   /output  projected moments
+ */
+
+int soot::realizableMoments(const vector<double> &M, vector<double> &Mp) {
+
+    int N = M.size();
+    Mp = M;
+    nRealize_checked++;
+
+    if (N == 0 || M[0] <= 0.0)
+        return 0;
+    if (N == 1 || M[1] <= 0.0)
+        return 1;
+
+    setMomentScales(M);
+    vector<double> m(N);
+    double s = N_ref;
+    for (int k=0; k<N; k++, s*=m_ref)
+        m[k] = M[k]/s;
+
+    //---------- Chebyshev algorithm: a_k (k <= (N-2)/2), b_k (k <= (N-1)/2)
+
+    int na = N/2;
+    int nb = (N+1)/2;
+    vector<double> a(na), b(nb);
+    vector<double> sig0(N, 0.0), sig1 = m, sig2(N, 0.0);   // rows k-2, k-1, k
+    a[0] = m[1]/m[0];
+    b[0] = m[0];
+    for (int k=1; k<nb; k++) {
+        for (int l=k; l<N-k; l++)
+            sig2[l] = sig1[l+1] - a[k-1]*sig1[l] - b[k-1]*sig0[l];
+        b[k] = sig2[k]/sig1[k-1];
+        if (k < na)
+            a[k] = sig2[k+1]/sig2[k] - sig1[k]/sig1[k-1];
+        sig0.swap(sig1);
+        sig1.swap(sig2);
+    }
+
+    //---------- zetas; j = first that is not positive
+
+    vector<double> zeta(N, 0.0);
+    int j = N;
+    for (int i=1; i<N; i++) {
+        zeta[i] = i == 1 ? a[0] : i%2 == 0 ? b[i/2]/zeta[i-1] : a[i/2] - zeta[i-1];
+        if (!(zeta[i] > 0.0)) {                          // also catches nan
+            j = i;
+            break;
+        }
+    }
+    if (j == N)
+        return N;
+
+    //---------- projection: moments of the Jacobi matrix ending at zeta_j = 0
+
+    int p = (j+1)/2;                                     // nodes
+    vector<double> ap(a.begin(), a.begin()+p);
+    if (j%2 == 1)
+        ap[p-1] = zeta[j-1];                             // a_(p-1) = zeta_(j-1) + 0
+    vector<double> v(p, 0.0), Jv(p);
+    v[0] = 1.0;
+    s = N_ref;
+    for (int k=0; k<N; k++, s*=m_ref) {
+        if (k >= j) {
+            Mp[k] = v[0]*m[0]*s;                         // m_k = m_0*(J^k)_00
+            realize_maxCorr = max(realize_maxCorr, abs(Mp[k] - M[k])/Mp[k]);
+        }
+        for (int i=0; i<p; i++)                          // tridiagonal J: sub-diagonal 1, super-diagonal b
+            Jv[i] = (i > 0 ? v[i-1] : 0.0) + ap[i]*v[i] + (i < p-1 ? b[i+1]*v[i+1] : 0.0);
+        v.swap(Jv);
+    }
+    nRealize_projected++;
+
+    return j;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! project_moments function
+ *
+ *      Batched realizability projection of transported moments, e.g.,
+ *      after a transport step: each cell's sootvar set is replaced by its
+ *      projection (see realizableMoments). Returns the number of cells that
+ *      were changed; see also nRealize_projected and realize_maxCorr.
+ *
+ *      @param sootvar_cells   /inout  soot variables of each cell
+ */
+
+int soot::project_moments(vector<vector<double> > &sootvar_cells) {
+
+    int nProj = 0;
+    vector<double> Mp;
+    for (int ic=0; ic<sootvar_cells.size(); ic++)
+        if (realizableMoments(sootvar_cells[ic], Mp) < (int)sootvar_cells[ic].size() &&
+            sootvar_cells[ic][0] > 0.0 && sootvar_cells[ic][1] > 0.0) {
+            sootvar_cells[ic] = Mp;
+            nProj++;
+        }
+
+    return nProj;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! cunningham function
  *
- *      Sets gas state properties. These will be implied by functions in this
- *         class that depend on the gas state.
+ *      Returns the Cunningham slip correction factor.
+ *      Seinfeld p. 372 eq. 9.34. This is for air at 298 K, 1 atm
+ *      for D<<mfp_g, Cc = 1 + 1.657*Kn; Seinfeld p. 380: 10% error at Kn=1, 0% at Kn=0.01, 100
  *
- *      @param T_p      /input (K)
- *      @param P_p      /input (Pa)
- *      @param rho_p    /input (gas density, kg/m3)
- *      @param MW_p     /input (mean molecular weight, kg/kmol)
- *      @param mu_p     /input (dynamic viscosity kg/m*s)
- *      @param y_p      /input mass fractions
+ *      @param Kn   /input  Knudsen number 2*mfp_g/Dp
  */
 
-void soot::set_gas_state_vars(const double   &T_p,
-                              const double   &P_p,
-                              const double   &rho_p,
-                              const double   &MW_p,
-                              const double   &mu_p,
-                              vector<double> &y_p){
-    T   = T_p;
-    P   = P_p;
-    rho = rho_p;
-    MW  = MW_p;
-    mu  = mu_p;
-    yi  = &y_p;
+double soot::cunningham(const double &Kn) {
 
+    return 1 + Kn*(1.257 + 0.4*sootMath::exp(-1.1/Kn));
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -167,10 +1265,16 @@ double soot::getNucleationRate(const vector<double> &mi, const vector<double> &w
 
     if (nucleation_mech      == "NONE")
         return 0;
-    else if (nucleation_mech == "LL")
-        return nucleation_LL();
-    else if (nucleation_mech == "LIN")
-        return nucleation_Linstedt();
+    else if ((nucleation_mech == "LL" || nucleation_mech == "LIN") && gasUnchanged && cacheHave_nuc)
+        return cacheJnuc;                    // gas-only rate; see set_src_cache
+    else if (nucleation_mech == "LL") {
+        cacheHave_nuc = cacheRecording;
+        return cacheJnuc = nucleation_LL();
+    }
+    else if (nucleation_mech == "LIN") {
+        cacheHave_nuc = cacheRecording;
+        return cacheJnuc = nucleation_Linstedt();
+    }
     else if (nucleation_mech == "PAH")
         return nucleation_PAH(mi, wi);
     else {
@@ -199,8 +1303,17 @@ double soot::getGrowthRate(const double &M0, const double &M1) {
 
     if (growth_mech      == "NONE")
         return 0;
-    else if (growth_mech == "LIN")
-        return growth_Lindstedt();
+    else if (growth_mech == "LIN" && gasUnchanged && cacheHave_grw)
+        return cacheKgrw;                    // gas-only rate; see set_src_cache
+    else if (skipSurfaceProcess(true, M0, M1)) {
+        nSkip_grw++;
+        cacheHave_grw = cacheRecording;
+        return cacheKgrw = 0;
+    }
+    else if (growth_mech == "LIN") {
+        cacheHave_grw = cacheRecording;
+        return cacheKgrw = growth_Lindstedt();
+    }
     else if (growth_mech == "LL")
         return growth_LL(M0, M1);
     else if (growth_mech == "HACA")
@@ -230,12 +1343,25 @@ double soot::getOxidationRate(const double &M0, const double &M1) {
 
     if (oxidation_mech      == "NONE")
         return 0;
-    else if (oxidation_mech == "LL")
-        return oxidation_LL();
-    else if (oxidation_mech == "LEE_NEOH")
-        return oxidation_Lee_Neoh();
-    else if (oxidation_mech == "NSC_NEOH")
-        return oxidation_NSC_Neoh();
+    else if (oxidation_mech != "HACA" && gasUnchanged && cacheHave_oxi)
+        return cacheKoxi;                    // gas-only rate; see set_src_cache
+    else if (skipSurfaceProcess(false, M0, M1)) {
+        nSkip_oxi++;
+        cacheHave_oxi = cacheRecording && growth_mech != "LL";   // LL bound depends on M0, M1
+        return cacheKoxi = 0;
+    }
+    else if (oxidation_mech == "LL") {
+        cacheHave_oxi = cacheRecording;
+        return cacheKoxi = oxidation_LL();
+    }
+    else if (oxidation_mech == "LEE_NEOH") {
+        cacheHave_oxi = cacheRecording;
+        return cacheKoxi = oxidation_Lee_Neoh();
+    }
+    else if (oxidation_mech == "NSC_NEOH") {
+        cacheHave_oxi = cacheRecording;
+        return cacheKoxi = oxidation_NSC_Neoh();
+    }
     else if (oxidation_mech == "HACA")
         return oxidation_HACA(M0, M1);
     else {
@@ -278,6 +1404,145 @@ double soot::getCoagulationRate(const double &m1, const double &m2) {
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/*! getCoagulationRate_pp function
+ *
+ *      Same as getCoagulationRate, but for particles i and j of the last
+ *      setParticleProps call; the kernels only combine cached properties.
+ *      Returns the value of the collision rate function beta in m3/#*s.
+ *
+ *      @param i       /input  index of particle 1 (ipp_dimer for the dimer)
+ *      @param j       /input  index of particle 2
+ *
+ *      Call setParticleProps first.
+ */
+
+double soot::getCoagulationRate_pp(const int &i, const int &j) {
+
+    if (coagulation_mech      == "NONE")
+        return 0;
+    else if (coagulation_mech == "LL")
+        return coagulation_LL_pp(i, j);
+    else if (coagulation_mech == "FUCHS")
+        return coagulation_Fuchs_pp(i, j);
+    else if (coagulation_mech == "FRENK")
+        return coagulation_Frenk_pp(i, j);
+    else {
+        cout << endl << "ERROR: Invalid soot coagulation mechanism." << endl;
+        exit(0);
+    }
+
+    return 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! coagulationRateBound_pp function
+ *
+ *      Cheap upper bound of getCoagulationRate_pp, for the coagulation pair
+ *      skip (see set_skip_tolerance). The Fuchs and Frenklach kernels are
+ *      at most their free-molecular limit, which needs one sqrt; LL is
+ *      returned as is. (With set_coag_regimes the continuum form is only
+ *      used where it is within coagRegimeTol of the full kernel.)
+ *      Returns m3/#*s.
+ *
+ *      @param i       /input  index of particle 1
+ *      @param j       /input  index of particle 2
+ *
+ *      Call setParticleProps first.
+ */
+
+double soot::coagulationRateBound_pp(const int &i, const int &j) {
+
+    if (coagulation_mech == "NONE" || pp_m[i] <= 0.0 || pp_m[j] <= 0.0)
+        return 0.0;
+    else if (coagulation_mech == "LL")
+        return coagulation_LL_pp(i, j);
+
+    double Dp12 = pp_Dp[i] + pp_Dp[j];
+    return eps_c*sqrt(M_PI*pp_kT*0.5*(pp_rm[i] + pp_rm[j])) * Dp12*Dp12;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setParticleProps function
+ *
+ *      Computes the properties of each particle that the pair coagulation
+ *      kernels need (diameter, Knudsen number, Cunningham factor,
+ *      diffusivity, Fuchs g term) once per particle and stores them in the
+ *      pp_ arrays, so the kernels are O(n) in transcendental work instead
+ *      of O(n^2). The entry after the particles (ipp_dimer) is the dimer
+ *      (m_dimer). The properties depend on the gas state (T, P, mu through
+ *      the mean free path), so they are never reused from another cell:
+ *      set_gas_state_vars marks them stale. set_Ndimer recomputes them
+ *      only if they are stale or were set for other masses; otherwise it
+ *      just updates the dimer entry after set_m_dimer.
+ *
+ *      @param mi    /input vector of soot particle sizes (kg)
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+void soot::setParticleProps(const vector<double> &mi) {
+
+    int n = mi.size();
+
+    pp_m.resize(n+1);
+    pp_rm.resize(n+1);
+    pp_Dp.resize(n+1);
+    pp_Kn.resize(n+1);
+    pp_CcDp.resize(n+1);
+    pp_D.resize(n+1);
+    pp_g.resize(n+1);
+
+    ipp_dimer = n;
+    pp_kT     = kb*T;
+
+    for (int i=0; i<n; i++)
+        setParticleProp(i, mi[i]);
+    setParticleProp(ipp_dimer, m_dimer);
+
+    pp_current = true;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setParticleProp function
+ *
+ *      Sets the cached coagulation properties of particle i (see
+ *      setParticleProps). Particles with m <= 0 get zeros and give beta = 0.
+ *
+ *      @param i     /input index in the pp_ arrays
+ *      @param m     /input particle mass (kg)
+ */
+
+void soot::setParticleProp(const int &i, const double &m) {
+
+    pp_m[i] = m;
+
+    if (m <= 0.0) {
+        pp_rm[i] = pp_Dp[i] = pp_Kn[i] = pp_CcDp[i] = pp_D[i] = pp_g[i] = 0.0;
+        return;
+    }
+
+    double Dp = sootMath::cbrt(6.0*m/M_PI/rhoSoot);
+    double Kn = 2.0*get_gas_mean_free_path()/Dp;
+    double Cc = cunningham(Kn);
+    double D  = pp_kT*Cc/(3.0*M_PI*mu*Dp);
+    double c  = sqrt(8.0*pp_kT/M_PI/m);
+    double l  = 8.0*D/M_PI/c;
+    double s  = Dp+l;
+    double q  = Dp*Dp + l*l;
+
+    pp_rm[i]   = 1.0/m;
+    pp_Dp[i]   = Dp;
+    pp_Kn[i]   = l/Dp;
+    pp_CcDp[i] = Cc/Dp;
+    pp_D[i]    = D;
+    pp_g[i]    = sqrt(2.0)/3.0/Dp/l*( s*s*s - q*sqrt(q) ) - sqrt(2.0)*Dp;
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /*! Nucleation by Leung_Lindstedt (1991)
  *
@@ -290,7 +1555,7 @@ double soot::getCoagulationRate(const double &m1, const double &m2) {
 double soot::nucleation_LL() {
 
     double cC2H2 = rho * (*yi)[i_c2h2] / MW_sp[i_c2h2];   // kmol/m3
-    double Rnuc  =  0.1E5 * exp(-21100/T) * cC2H2;        // kmol/m^3*s
+    double Rnuc  =  getRateFactor(rf_nuc_LL) * cC2H2;     // kmol/m^3*s
 
     rC2H2_rSoot_n  = -MW_sp[i_c2h2]/(2*MW_c);             // kg C2H2 / kg Soot
     rH2_rSoot_ncnd =  MW_sp[i_h2]  /(2*MW_c);             // kg H2   / kg Soot
@@ -313,7 +1578,7 @@ double soot::nucleation_LL() {
 double soot::nucleation_Linstedt() {
 
     double cC2H2 = rho * (*yi)[i_c2h2] / MW_sp[i_c2h2];   // kmol/m3
-    double Rnuc  =  0.63E4 * exp(-21100/T) * cC2H2;       // kmol/m^3*s
+    double Rnuc  =  getRateFactor(rf_nuc_LIN) * cC2H2;    // kmol/m^3*s
 
     rC2H2_rSoot_n  = -MW_sp[i_c2h2]/(2*MW_c);             // kg C2H2 / kg Soot
     rH2_rSoot_ncnd =  MW_sp[i_h2]  /(2*MW_c);             // kg H2   / kg Soot
@@ -325,7 +1590,8 @@ double soot::nucleation_Linstedt() {
 ////////////////////////////////////////////////////////////////////////////////
 /*! Helper function for PAH nucleation, and condensation
  *
- *      Sets the dimer mass m_dimer.
+ *      Sets the dimer formation rate wdotD, the dimer mass m_dimer, the
+ *      effective Cmin, and the PAH/H2 gas source ratios.
  *
  *      Rate from Blanquart & Pitsch (2009) article "A joint
  *      volume-surface-hydrogen multi-variate model for soot formation," ch. 27
@@ -334,40 +1600,55 @@ double soot::nucleation_Linstedt() {
  *
  *      Call set_gas_state_vars first.
  *
- *      @param mi    /input vector of soot particle sizes
- *      @param wi    /input vector of soot particle weights
- *
- *      Note, Cmin is reset. (Some mechanisms have Cmin as an input).
- *      Note, the "preFac" is (1/2) the F.M. rate in coagulation_Frenk without eps_c.
+ *      Note, Cmin is reset from the PAH mix on each call. (Some mechanisms have Cmin as an input).
+ *      Note, the per-species constants (wdot_pah_coef) are set in the constructor.
  *
  */
 
 double soot::set_m_dimer() {
 
+    if (gasUnchanged && cacheHave_dimer)     // gas-only; see set_src_cache
+        return wdotD;
+    cacheHave_dimer = cacheRecording;
+
     //------------ compute wdotD, the dimer self collision rate
 
-    double preFac = sqrt(4*M_PI*kb*T)*pow(6/(M_PI*rhoSoot), 2.0/3.0);
-    double wdotD = 0.0;                      // dimer self collision rate (formation rate: #/m3*s)
-    double gamma_i;                          // sticking coefficient
-    double m_ipah;                           // PAH species mass per molecule
-    double N_i;                              // PAH species number density: molecules / m3
-    double wdoti = 0.0;                      // convenience variable
-    m_dimer = 0.0;                           // dimer mass kg/part.
-    for(int i=0; i<i_pah.size(); i++) {
-        m_ipah  = MW_sp[i_pah[i]]/Na;
-        gamma_i = m_ipah > 153 ? 1.501E-11*pow(m_ipah,4) : 1.501E-11*pow(m_ipah,4) / 3.0;
-        N_i     = rho * (*yi)[i_pah[i]] / MW_sp[i_pah[i]] * Na;
-        wdoti   = abs(gamma_i * preFac * pow(m_ipah, 1.0/6.0) * N_i*N_i);
-        wdotD   += wdoti;
-        m_dimer += wdoti*m_ipah;
-        Cmin    += wdoti*nC_PAH[i];
-        //Cmin    += wdoti*gas->nAtoms(i_pah[i],i_elem_c);
-        rPAH_rSoot_ncnd[i] = wdoti*m_ipah;
-    }
+    double fac = sqrt(T)*rho*rho;            // wdot_i = fac*coef_i*y_i^2
+    double nC_D;                             // wdot weighted carbon count
+    dimerSums(*yi, nPAHclass > 0, wdotD, m_dimer, nC_D);
+    wdotD   *= fac;                          // dimer self collision rate (formation rate: #/m3*s)
+    m_dimer *= fac;                          // sum(wdot_i*m_i)
+    nC_D    *= fac;
+
+    if (wdotD <= 0.0) {                      // no PAH: no dimers, keep the last Cmin
+        m_dimer = 0.0;
         for(int i=0; i<i_pah.size(); i++)
-            rPAH_rSoot_ncnd[i] /= m_dimer;      // now mdot_i_pah = pah_relative_rates[i]*mdot, where mdot is a total gas rate
+            rPAH_rSoot_ncnd[i] = 0.0;
+        return 0.0;
+    }
+
+    //------------ split of the dimer mass over the PAH species
+
+    double y;
+    if (nPAHclass == 0) {
+        for(int i=0; i<i_pah.size(); i++) {
+            y = (*yi)[i_pah[i]];
+            rPAH_rSoot_ncnd[i] = fac*wdot_pah_coef[i]*y*y * m_pah[i];
+        }
+    }
+    else {                                   // split class rates by each species' local share
+        for(int i=0; i<i_pah.size(); i++) {
+            int c = pah_class[i];
+            y = (*yi)[i_pah[i]];
+            rPAH_rSoot_ncnd[i] = Sclass[c] > 0.0 ? fac*class_coef[c]*Yclass[c]*Yclass[c] * class_m[c] *
+                                                   wdot_pah_coef[i]*y*y*m_pah[i] / Sclass[c] : 0.0;
+        }
+    }
+
+    for(int i=0; i<i_pah.size(); i++)
+        rPAH_rSoot_ncnd[i] /= m_dimer;       // now mdot_i_pah = pah_relative_rates[i]*mdot, where mdot is a total gas rate
     m_dimer *= 2/wdotD;
-    Cmin    *= 4/wdotD;                        // This is reset here. Some mechanisms have this as an input
+    Cmin     = 4*nC_D/wdotD;                 // This is reset here. Some mechanisms have this as an input
 
     for(int i=0; i<i_pah.size(); i++)
         rPAH_rSoot_ncnd[i] *= -2.0*m_dimer/(Cmin*MW_c/Na);
@@ -376,10 +1657,197 @@ double soot::set_m_dimer() {
     return wdotD;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/*! dimerSums function
+ *
+ *      Sums over the PAH species (or the lumped classes) for set_m_dimer:
+ *      w = sum(wdot_i), m = sum(wdot_i*m_i), nC = sum(wdot_i*nC_i), with
+ *      wdot_i = coef_i*y_i^2 (the common factor sqrt(T)*rho^2 is left out).
+ *      For lumped classes, also sets Yclass and Sclass (the class sums of
+ *      coef_i*y_i^2*m_i that split a class's dimer mass over its species).
+ *
+ *      @param y_p     /input  gas species mass fractions
+ *      @param lumped  /input  use the lumped PAH classes
+ *      @param w       /output dimer formation rate (#/m3*s)
+ *      @param m       /output wdot weighted PAH mass
+ *      @param nC      /output wdot weighted carbon count
+ */
+
+void soot::dimerSums(const vector<double> &y_p, const bool &lumped, double &w, double &m, double &nC) {
+
+    double wdoti;                            // species (class) self collision rate / (sqrt(T)*rho^2)
+    double y;
+    w  = 0.0;
+    m  = 0.0;
+    nC = 0.0;
+
+    if (!lumped) {
+        for(int i=0; i<i_pah.size(); i++) {
+            y     = y_p[i_pah[i]];
+            wdoti = wdot_pah_coef[i]*y*y;
+            w    += wdoti;
+            m    += wdoti*m_pah[i];
+            nC   += wdoti*nC_PAH[i];
+        }
+        return;
+    }
+
+    Yclass.assign(nPAHclass, 0.0);
+    Sclass.assign(nPAHclass, 0.0);
+    for(int i=0; i<i_pah.size(); i++) {
+        y = y_p[i_pah[i]];
+        Yclass[pah_class[i]] += y;
+        Sclass[pah_class[i]] += wdot_pah_coef[i]*y*y*m_pah[i];
+    }
+    for(int c=0; c<nPAHclass; c++) {
+        wdoti = class_coef[c]*Yclass[c]*Yclass[c];
+        w    += wdoti;
+        m    += wdoti*class_m[c];
+        nC   += wdoti*class_nC[c];
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_pah_lumping function
+ *
+ *      Groups the PAH species into p_nPAHclass classes by carbon number
+ *      (bins uniform in log(nC) between the smallest and largest PAH), so
+ *      set_m_dimer works on the classes instead of every PAH species.
+ *      Within a class the species mass fractions are taken in fixed
+ *      proportion w_i (from yRef, or equal if yRef is empty), so
+ *          coef_c = sum(coef_i*w_i^2),  m_c = sum(coef_i*w_i^2*m_i)/coef_c,
+ *      and the class's dimer mass is split over its species by their local
+ *      shares coef_i*y_i^2*m_i / sum_class(coef_j*y_j^2*m_j), so a species
+ *      absent from the gas is not consumed. Call once after construction;
+ *      p_nPAHclass = 0 (or >= the number of PAH species) turns lumping off.
+ *
+ *      Returns the relative error in wdotD, m_dimer, Cmin (max of the three)
+ *      for a composition with equal PAH mass fractions, which measures the
+ *      cost of the fixed-proportion assumption. Use pah_lumping_error for
+ *      other compositions.
+ *
+ *      @param p_nPAHclass  /input  number of PAH classes
+ *      @param yRef         /input  reference gas mass fractions (all species) for the class weights
+ */
+
+double soot::set_pah_lumping(const int &p_nPAHclass, const vector<double> &yRef) {
+
+    int nPAH = i_pah.size();
+
+    if (p_nPAHclass <= 0 || p_nPAHclass >= nPAH) {
+        nPAHclass = 0;
+        return 0.0;
+    }
+    if (yRef.size() > 0 && yRef.size() != MW_sp.size()) {
+        cout << endl << "ERROR: set_pah_lumping: yRef must have one entry per gas species." << endl;
+        exit(0);
+    }
+
+    //---------- class of each species: bins uniform in log(nC)
+
+    double lnCmin = log(*min_element(nC_PAH.begin(), nC_PAH.begin()+nPAH));
+    double lnCmax = log(*max_element(nC_PAH.begin(), nC_PAH.begin()+nPAH));
+    double dlnC   = (lnCmax - lnCmin)/p_nPAHclass;
+
+    vector<int> bin(nPAH);
+    vector<int> binUsed(p_nPAHclass, 0);
+    for(int i=0; i<nPAH; i++) {
+        bin[i] = dlnC > 0.0 ? (int)((log(nC_PAH[i]) - lnCmin)/dlnC) : 0;
+        bin[i] = min(bin[i], p_nPAHclass-1);
+        binUsed[bin[i]] = 1;
+    }
+    vector<int> binClass(p_nPAHclass);                  // drop empty bins
+    nPAHclass = 0;
+    for(int b=0; b<p_nPAHclass; b++)
+        binClass[b] = binUsed[b] ? nPAHclass++ : -1;
+    pah_class.resize(nPAH);
+    for(int i=0; i<nPAH; i++)
+        pah_class[i] = binClass[bin[i]];
+
+    //---------- fixed within-class weights and class constants
+
+    vector<double> wt(nPAH);
+    vector<double> wtSum(nPAHclass, 0.0);
+    for(int i=0; i<nPAH; i++) {
+        wt[i] = yRef.size() > 0 ? max(yRef[i_pah[i]], 0.0) : 1.0;
+        wtSum[pah_class[i]] += wt[i];
+    }
+    for(int i=0; i<nPAH; i++) {                         // equal weights for classes absent from yRef
+        int c = pah_class[i];
+        if (wtSum[c] > 0.0)
+            wt[i] /= wtSum[c];
+    }
+    for(int c=0; c<nPAHclass; c++) {
+        if (wtSum[c] > 0.0) continue;
+        int nc = count(pah_class.begin(), pah_class.end(), c);
+        for(int i=0; i<nPAH; i++)
+            if (pah_class[i] == c) wt[i] = 1.0/nc;
+    }
+
+    class_coef.assign(nPAHclass, 0.0);
+    class_m.assign(nPAHclass, 0.0);
+    class_nC.assign(nPAHclass, 0.0);
+    for(int i=0; i<nPAH; i++) {
+        int c = pah_class[i];
+        double a = wdot_pah_coef[i]*wt[i]*wt[i];
+        class_coef[c] += a;
+        class_m[c]    += a*m_pah[i];
+        class_nC[c]   += a*nC_PAH[i];
+    }
+    for(int c=0; c<nPAHclass; c++) {
+        class_m[c]  /= class_coef[c];
+        class_nC[c] /= class_coef[c];
+    }
+    Yclass.resize(nPAHclass);
+    Sclass.resize(nPAHclass);
+
+    //---------- error at equal PAH mass fractions
+
+    vector<double> yEq(MW_sp.size(), 0.0);
+    for(int i=0; i<nPAH; i++)
+        yEq[i_pah[i]] = 1.0/nPAH;
+
+    return pah_lumping_error(yEq);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! pah_lumping_error function
+ *
+ *      Returns the maximum relative error of wdotD, m_dimer, and Cmin from
+ *      the lumped PAH classes compared to the full species sums, for gas
+ *      mass fractions y_p. T and rho cancel in the ratios.
+ *
+ *      @param y_p   /input  gas species mass fractions
+ */
+
+double soot::pah_lumping_error(const vector<double> &y_p) {
+
+    if (nPAHclass == 0)
+        return 0.0;
+
+    double w, m, nC, wL, mL, nCL;
+    dimerSums(y_p, false, w,  m,  nC);
+    dimerSums(y_p, true,  wL, mL, nCL);
+
+    if (w <= 0.0)
+        return 0.0;
+
+    double err = abs(wL/w - 1.0);
+    err = max(err, abs((mL/wL)/(m/w) - 1.0));
+    err = max(err, abs((nCL/wL)/(nC/w) - 1.0));
+    return err;
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /*! Helper function for PAH nucleation, and condensation
  *
- *      Sets the dimer number density DIMER (#/m3).
+ *      Sets the dimer number density DIMER (#/m3) for discrete particles.
+ *      This is the whole dimer steady-state solve: DIMER, m_dimer, Cmin,
+ *      beta_DD and the pp_ arrays are then used as is by
+ *      nucleation_PAH and the condensation terms of each model.
  *
  *      Rate from Blanquart & Pitsch (2009) article "A joint
  *      volume-surface-hydrogen multi-variate model for soot formation," ch. 27
@@ -394,23 +1862,53 @@ double soot::set_m_dimer() {
 
 void soot::set_Ndimer(const vector<double> &mi, const vector<double> &wi) {
 
-    double wdotD = set_m_dimer();
+    set_m_dimer();
+
+    //------------- particle properties for the dimer-soot sums (at this gas state)
+    // QMOM and SECT have already set them for mi: only the dimer entry is new.
 
-    //------------- compute the dimer concentration as solution to quadratic
-    // Steady state approximation.
-    // Dimer creation rate = dimer destruction from self collision + from soot collision
-    // wdotD = beta_DD*[D]^2 + sum(beta_DS*w_i)*[D]
+    bool propsSet = pp_current && pp_m.size() == mi.size()+1;
+    for (int i=0; propsSet && i<mi.size(); i++)
+        propsSet = pp_m[i] == mi[i];
 
-    double beta_DD = coagulation_Frenk(m_dimer, m_dimer);          // dimer self-collision rate
+    if (propsSet)
+        setParticleProp(ipp_dimer, m_dimer);
+    else
+        setParticleProps(mi);
+
+    beta_DD = coagulation_Frenk_pp(ipp_dimer, ipp_dimer);          // dimer self-collision rate
     double I_beta_DS = 0.0;                                        // sum of dimer-soot collision rates
     for(int i=0; i<mi.size(); i++)                                 // loop over soot "particles" (abscissas)
-        I_beta_DS += abs(wi[i]) * coagulation_Frenk(m_dimer, mi[i]);
+        I_beta_DS += abs(wi[i]) * coagulation_Frenk_pp(ipp_dimer, i);
+
+    solve_Ndimer(I_beta_DS);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Helper function for PAH nucleation, and condensation
+ *
+ *      Sets and returns the steady-state dimer number density DIMER (#/m3).
+ *      Dimer creation rate = dimer destruction from self collision + from soot collision:
+ *      wdotD = beta_DD*[D]^2 + sum(beta_DS*w_i)*[D]
+ *
+ *      Call set_m_dimer and set beta_DD first.
+ *
+ *      @param I_beta_DS  /input  sum (or integral) of dimer-soot collision rates (1/s)
+ *
+ */
+
+double soot::solve_Ndimer(const double &I_beta_DS) {
 
     //------------- solve quadratic for D: beta_DD*(D^2) + I_beta_DS*(D) - wdotD = 0
     // See numerical recipies 3rd ed. sec 5.6 page 227.
     // Choosing the positive root.
 
-    DIMER = 2.0*wdotD/(I_beta_DS + sqrt(I_beta_DS*I_beta_DS + 4*beta_DD*wdotD));   // #/m3
+    double den = I_beta_DS + sqrt(I_beta_DS*I_beta_DS + 4*beta_DD*wdotD);
+    DIMER = den > 0.0 ? 2.0*wdotD/den : 0.0;                      // #/m3
+    wdotD_cnd = DIMER*I_beta_DS;                                   // #/m3*s, used to estimate condensation
+
+    return DIMER;
 
 }
 
@@ -433,7 +1931,6 @@ void soot::set_Ndimer(const vector<double> &mi, const vector<double> &wi) {
 double soot::nucleation_PAH(const vector<double> &mi, const vector<double> &wi) {
 
     set_Ndimer(mi, wi);
-    double beta_DD = coagulation_Frenk(m_dimer, m_dimer);          // dimer self-collision rate
 
     return 0.5*beta_DD*DIMER*DIMER;                                // Jnuc (=) #/m3*s
 
@@ -453,7 +1950,7 @@ double soot::nucleation_PAH(const vector<double> &mi, const vector<double> &wi)
 double soot::growth_Lindstedt() {
 
     double cC2H2 = rho * (*yi)[i_c2h2] / MW_sp[i_c2h2];        // kmol/m3
-    double rSoot = 750.0 * exp(-12100.0/T) * cC2H2 * 2.0*MW_c; // kg/m^2*s
+    double rSoot = getRateFactor(rf_grw_LIN) * cC2H2 * 2.0*MW_c; // kg/m^2*s
 
     rC2H2_rSoot_go = -MW_sp[i_c2h2]/(2*MW_c);                      // kg C2H2 / kg Soot
     rH2_rSoot_go   =  MW_sp[i_h2]  /(2*MW_c);                      // kg H2   / kg Soot
@@ -481,12 +1978,12 @@ double soot::growth_LL(const double &M0, const double &M1) {
     double rSoot = 0.0;
 
     if (M0 > 0.0)
-        Am2m3 = M_PI * pow(abs(6/(M_PI*rhoSoot)*M1/M0),2.0/3.0) * abs(M0);    // m^2_soot / m^3_total = pi*di^2*M0
+        Am2m3 = M_PI * sootMath::pow23(abs(6/(M_PI*rhoSoot)*M1/M0)) * abs(M0);    // m^2_soot / m^3_total = pi*di^2*M0
 
     cC2H2 = rho * (*yi)[i_c2h2] / MW_sp[i_c2h2];                          // kmol/m3
 
     if (Am2m3 > 0)
-        rSoot = 0.6E4 * exp(-12100.0/T) * cC2H2/sqrt(Am2m3) * 2.0*MW_c;       // kg/m^2*s
+        rSoot = getRateFactor(rf_grw_LL) * cC2H2/sqrt(Am2m3) * 2.0*MW_c;     // kg/m^2*s
 
     rC2H2_rSoot_go = -MW_sp[i_c2h2]/(2*MW_c);                      // kg C2H2 / kg Soot
     rH2_rSoot_go   =  MW_sp[i_h2]  /(2*MW_c);                      // kg H2   / kg Soot
@@ -522,20 +2019,19 @@ double soot::growth_HACA(const double &M0, const double &M1) {
     double cH2O  = rho * (*yi)[i_h2o]  / MW_sp[i_h2o];       // kmol/m3
 
     //---------- calculate alpha, other constants
-    double RT       = 1.9872036E-3 * T;         // R (=) kcal/mol
     double chi_soot = 2.3E15;                   // (=) sites/cm^2
     double a_param  = 33.167 - 0.0154 * T;      // a parameter for calculating alpha
     double b_param  = -2.5786 + 0.00112 * T;    // b parameter for calculating alpha
 
-    //---------- calculate raw HACA reaction rates
-    double fR1 = 4.2E13 * exp(-13.0 / RT) * cH / 1000;
-    double rR1 = 3.9E12 * exp(-11.0 / RT) * cH2 / 1000;
-    double fR2 = 1.0E10 * pow(T,0.734) * exp(-1.43 / RT) * cOH / 1000;
-    double rR2 = 3.68E8 * pow(T,1.139) * exp(-17.1 / RT) * cH2O /1000;
+    //---------- calculate raw HACA reaction rates (T-dependent factors in rateParams)
+    double fR1 = getRateFactor(rf_HACA_fR1) * cH;
+    double rR1 = getRateFactor(rf_HACA_rR1) * cH2;
+    double fR2 = getRateFactor(rf_HACA_fR2) * cOH;
+    double rR2 = getRateFactor(rf_HACA_rR2) * cH2O;
     double fR3 = 2.0E13 * cH / 1000;
-    double fR4 = 8.00E7 * pow(T,1.56) * exp(-3.8 / RT) * cC2H2 / 1000;
-    double fR5 = 2.2E12 * exp(-7.5 / RT) * cO2 / 1000;
-    double fR6 = 1290.0 * 0.13 * P * (cOH/rho*MW_sp[i_oh]) / sqrt(T);    // gamma = 0.13 from Neoh et al.
+    double fR4 = getRateFactor(rf_HACA_fR4) * cC2H2;
+    double fR5 = getRateFactor(rf_HACA_fR5) * cO2;
+    double fR6 = getRateFactor(rf_Neoh_OH) * P * (cOH/rho*MW_sp[i_oh]);  // gamma = 0.13 from Neoh et al.
 
     //---------- Steady state calculation of chi for soot radical; see Frenklach 1990 pg. 1561
     double denom = rR1 + rR2 + fR3 + fR4 + fR5;
@@ -545,7 +2041,7 @@ double soot::growth_HACA(const double &M0, const double &M1) {
 
     double alpha = 1.0;                                            // alpha = fraction of available surface sites
     if (M0 > 0.0)
-        alpha = tanh(a_param/log10(M1/M0)+b_param);
+        alpha = sootMath::tanh(a_param/sootMath::log10(M1/M0)+b_param);
     if (alpha < 0.0)
         alpha = 1.0;
 
@@ -569,7 +2065,7 @@ double soot::growth_HACA(const double &M0, const double &M1) {
 double soot::oxidation_LL() {
 
     double cO2 = rho * (*yi)[i_o2] / MW_sp[i_o2];             // kmol/m3
-    double rSoot = 0.1E5 * sqrt(T) * exp(-19680.0/T) * cO2 * MW_c;    // kg/m^2*s
+    double rSoot = getRateFactor(rf_oxi_LL) * cO2 * MW_c;     // kg/m^2*s
 
     rO2_rSoot_go = -0.5*MW_sp[i_o2]/MW_c;                        // kg O2 / kg Soot
     rCO_rSoot_go =      MW_sp[i_co]/MW_c;                        // kg CO / kg Soot
@@ -597,8 +2093,8 @@ double soot::oxidation_Lee_Neoh() {
     double pO2 = (*yi)[i_o2] * MW / MW_sp[i_o2] * P / 101325.0;      // partial pressure of O2 (atm)
     double pOH = (*yi)[i_oh] * MW / MW_sp[i_oh] * P / 101325.0;      // partial pressure of OH (atm)
 
-    double rSootO2 = 1.085E4*pO2/sqrt(T)*exp(-1.977824E4/T)/1000.0;  // kg/m^2*s
-    double rSootOH = 1290.0*0.13*pOH/sqrt(T);                        // kg/m^2*s
+    double rSootO2 = getRateFactor(rf_oxi_Lee)*pO2;                  // kg/m^2*s
+    double rSootOH = getRateFactor(rf_Neoh_OH)*pOH;                  // kg/m^2*s
 
     rO2_rSoot_go = -0.5*MW_sp[i_o2]/MW_c * rSootO2/(rSootO2+rSootOH);    // kg O2 / kg Soot
     rOH_rSoot_go =     -MW_sp[i_oh]/MW_c * rSootOH/(rSootO2+rSootOH);    // kg OH / kg Soot
@@ -628,15 +2124,15 @@ double soot::oxidation_NSC_Neoh() {
     double pO2 = (*yi)[i_o2] * MW / MW_sp[i_o2] * P / 101325.0; // partial pressure of O2 (atm)
     double pOH = (*yi)[i_oh] * MW / MW_sp[i_oh] * P / 101325.0; // partial pressure of OH (atm)
 
-    double kA = 20.0     * exp(-15098.0/T);                     // rate constants
-    double kB = 4.46E-3  * exp(-7650.0/T);
-    double kT = 1.51E5   * exp(-48817.0/T);
-    double kz = 21.3     * exp(2063.0/T);
+    double kA = getRateFactor(rf_NSC_kA);                       // rate constants
+    double kB = getRateFactor(rf_NSC_kB);
+    double kT = getRateFactor(rf_NSC_kT);
+    double kz = getRateFactor(rf_NSC_kz);
 
     double x  = 1.0/(1.0+kT/(kB*pO2));                          // x = unitless fraction
     double NSC_rate = kA*pO2*x/(1.0+kz*pO2) + kB*pO2*(1.0-x);   // kmol/m^2*s
     double rSootO2 = NSC_rate*rhoSoot;                          // kg/m2*s
-    double rSootOH = 1290.0*0.13*pOH/sqrt(T);                   // kg/m2*s
+    double rSootOH = getRateFactor(rf_Neoh_OH)*pOH;             // kg/m2*s
 
     rO2_rSoot_go = -0.5*MW_sp[i_o2]/MW_c * rSootO2/(rSootO2+rSootOH);    // kg O2 / kg Soot
     rOH_rSoot_go =     -MW_sp[i_oh]/MW_c * rSootOH/(rSootO2+rSootOH);    // kg OH / kg Soot
@@ -674,20 +2170,19 @@ double soot::oxidation_HACA(const double &M0, const double &M1) {
     double cH2O  = rho * (*yi)[i_h2o]  / MW_sp[i_h2o];       // kmol/m3
 
     //---------- calculate alpha, other constants
-    double RT       = 1.9872036E-3 * T;         // R (=) kcal/mol
     double chi_soot = 2.3E15;                   // (=) sites/cm^2
     double a_param  = 33.167 - 0.0154 * T;      // a parameter for calculating alpha
     double b_param  = -2.5786 + 0.00112 * T;    // b parameter for calculating alpha
 
-    //---------- calculate raw HACA reaction rates
-    double fR1 = 4.2E13 * exp(-13.0 / RT) * cH / 1000;
-    double rR1 = 3.9E12 * exp(-11.0 / RT) * cH2 / 1000;
-    double fR2 = 1.0E10 * pow(T,0.734) * exp(-1.43 / RT) * cOH / 1000;
-    double rR2 = 3.68E8 * pow(T,1.139) * exp(-17.1 / RT) * cH2O /1000;
+    //---------- calculate raw HACA reaction rates (T-dependent factors in rateParams)
+    double fR1 = getRateFactor(rf_HACA_fR1) * cH;
+    double rR1 = getRateFactor(rf_HACA_rR1) * cH2;
+    double fR2 = getRateFactor(rf_HACA_fR2) * cOH;
+    double rR2 = getRateFactor(rf_HACA_rR2) * cH2O;
     double fR3 = 2.0E13 * cH / 1000;
-    double fR4 = 8.00E7 * pow(T,1.56) * exp(-3.8 / RT) * cC2H2 / 1000;
-    double fR5 = 2.2E12 * exp(-7.5 / RT) * cO2 / 1000;
-    double fR6 = 1290.0 * 0.13 * P * (cOH/rho*MW_sp[i_oh]) / sqrt(T);    // gamma = 0.13 from Neoh et al.
+    double fR4 = getRateFactor(rf_HACA_fR4) * cC2H2;
+    double fR5 = getRateFactor(rf_HACA_fR5) * cO2;
+    double fR6 = getRateFactor(rf_Neoh_OH) * P * (cOH/rho*MW_sp[i_oh]);  // gamma = 0.13 from Neoh et al.
 
     //---------- Steady state calculation of chi for soot radical; see Frenklach 1990 pg. 1561
     double denom = rR1 + rR2 + fR3 + fR4 + fR5;
@@ -697,7 +2192,7 @@ double soot::oxidation_HACA(const double &M0, const double &M1) {
 
     double alpha = 1.0;                                            // alpha = fraction of available surface sites
     if (M0 > 0.0)
-        alpha = tanh(a_param/log10(M1/M0)+b_param);
+        alpha = sootMath::tanh(a_param/sootMath::log10(M1/M0)+b_param);
     if (alpha < 0.0)
         alpha = 1.0;
 
@@ -737,7 +2232,7 @@ double soot::coagulation_LL (const double &m1, const double &m2) {
     //return Ca/2.0*sqrt(M_PI*kb*T*0.5/m12) * pow(Dp1+Dp2, 2.0);
 
     //--------- Equivalent L&L form assuming m1 = m2
-    double Dp1 = pow(6.0*abs(m1)/M_PI/rhoSoot, 1.0/3.0);
+    double Dp1 = sootMath::cbrt(6.0*abs(m1)/M_PI/rhoSoot);
     return 2.0*Ca*sqrt(Dp1*6*kb*T/rhoSoot);
 
 }
@@ -763,8 +2258,8 @@ double soot::coagulation_LL (const double &m1, const double &m2) {
 
 double soot::coagulation_Fuchs(const double &m1, const double &m2) {
 
-    double Dp1 = pow(6.0*abs(m1)/M_PI/rhoSoot, 1.0/3.0);
-    double Dp2 = pow(6.0*abs(m2)/M_PI/rhoSoot, 1.0/3.0);
+    double Dp1 = sootMath::cbrt(6.0*abs(m1)/M_PI/rhoSoot);
+    double Dp2 = sootMath::cbrt(6.0*abs(m2)/M_PI/rhoSoot);
 
     double c1 = sqrt(8.0*kb*T/M_PI/m1);
     double c2 = sqrt(8.0*kb*T/M_PI/m2);
@@ -774,8 +2269,8 @@ double soot::coagulation_Fuchs(const double &m1, const double &m2) {
     double Kn1 = 2.0*mfp_g/Dp1;
     double Kn2 = 2.0*mfp_g/Dp2;
 
-    double Cc1 = 1 + Kn1*(1.257 + 0.4*exp(-1.1/Kn1));    // Seinfeld p. 372 eq. 9.34. This is for air at 298 K, 1 atm
-    double Cc2 = 1 + Kn2*(1.257 + 0.4*exp(-1.1/Kn2));    // for D<<mfp_g, Cc = 1 + 1.657*Kn; Seinfeld p. 380: 10% error at Kn=1, 0% at Kn=0.01, 100
+    double Cc1 = cunningham(Kn1);
+    double Cc2 = cunningham(Kn2);
 
     double D1 = kb*T*Cc1/(3.0*M_PI*mu*Dp1);
     double D2 = kb*T*Cc2/(3.0*M_PI*mu*Dp2);
@@ -783,8 +2278,25 @@ double soot::coagulation_Fuchs(const double &m1, const double &m2) {
     double l1 = 8.0*D1/M_PI/c1;
     double l2 = 8.0*D2/M_PI/c2;
 
-    double g1 = sqrt(2.0)/3.0/Dp1/l1*( pow(Dp1+l1,3.0) - pow(Dp1*Dp1 + l1*l1, 3.0/2.0) ) - sqrt(2.0)*Dp1;
-    double g2 = sqrt(2.0)/3.0/Dp2/l2*( pow(Dp2+l2,3.0) - pow(Dp2*Dp2 + l2*l2, 3.0/2.0) ) - sqrt(2.0)*Dp2;
+    if (useCoagRegimes) {                                // asymptotic limits by l/Dp: no g needed
+        if (l1 >= Kn_fm_Fuchs*Dp1 && l2 >= Kn_fm_Fuchs*Dp2) {
+            nPairs_fm++;
+            return M_PI/4.0*eps_c*sqrt(c1*c1+c2*c2)*(Dp1+Dp2)*(Dp1+Dp2);
+        }
+        if (l1 <= Kn_c_Fuchs*Dp1 && l2 <= Kn_c_Fuchs*Dp2) {
+            nPairs_c++;
+            return 2.0*M_PI*(D1+D2)*(Dp1+Dp2);
+        }
+        nPairs_tr++;
+    }
+
+    double s1 = Dp1+l1;                                  // (Dp+l)^3 and (Dp^2+l^2)^(3/2) without pow
+    double s2 = Dp2+l2;
+    double q1 = Dp1*Dp1 + l1*l1;
+    double q2 = Dp2*Dp2 + l2*l2;
+
+    double g1 = sqrt(2.0)/3.0/Dp1/l1*( s1*s1*s1 - q1*sqrt(q1) ) - sqrt(2.0)*Dp1;
+    double g2 = sqrt(2.0)/3.0/Dp2/l2*( s2*s2*s2 - q2*sqrt(q2) ) - sqrt(2.0)*Dp2;
 
     return 2.0*M_PI*(D1+D2)*(Dp1+Dp2) / ((Dp1+Dp2)/(Dp1+Dp2+2.0*sqrt(g1*g1+g2*g2)) + 8.0/eps_c*(D1+D2)/sqrt(c1*c1+c2*c2)/(Dp1+Dp2));
 
@@ -803,8 +2315,13 @@ double soot::coagulation_Fuchs(const double &m1, const double &m2) {
 
 double soot::coagulation_Frenk(const double &m1, const double &m2) {
 
-    double Dp1 = pow(6.0*abs(m1)/M_PI/rhoSoot, 1.0/3.0);
-    double Dp2 = pow(6.0*abs(m2)/M_PI/rhoSoot, 1.0/3.0);
+    double Dp1 = sootMath::cbrt(6.0*abs(m1)/M_PI/rhoSoot);
+    double Dp2 = sootMath::cbrt(6.0*abs(m2)/M_PI/rhoSoot);
+
+    double mfp_g = get_gas_mean_free_path();
+
+    double Kn1 = 2.0*mfp_g/Dp1;
+    double Kn2 = 2.0*mfp_g/Dp2;
 
     //------------ free molecular rate
 
@@ -814,22 +2331,133 @@ double soot::coagulation_Frenk(const double &m1, const double &m2) {
 
     //------------ continuum rate
 
-    double mfp_g = get_gas_mean_free_path();
-
-    double Kn1 = 2.0*mfp_g/Dp1;
-    double Kn2 = 2.0*mfp_g/Dp2;
-
-    double Cc1 = 1 + Kn1*(1.257 + 0.4*exp(-1.1/Kn1));    // Seinfeld p. 372 eq. 9.34. This is for air at 298 K, 1 atm
-    double Cc2 = 1 + Kn2*(1.257 + 0.4*exp(-1.1/Kn2));    // for D<<mfp_g, Cc = 1 + 1.657*Kn; Seinfeld p. 380: 10% error at Kn=1, 0% at Kn=0.01, 100
+    double Cc1 = cunningham(Kn1);
+    double Cc2 = cunningham(Kn2);
 
     double beta_12_C = 2*kb*T/(3*mu)*(Cc1/Dp1 + Cc2/Dp2)*(Dp1 + Dp2);
 
+    if (useCoagRegimes) {                                // asymptotic limits by l/Dp = 8*D/(pi*c*Dp)
+        double lD1 = 8.0/M_PI * kb*T*Cc1/(3.0*M_PI*mu*Dp1*Dp1) / sqrt(8.0*kb*T/M_PI/abs(m1));
+        double lD2 = 8.0/M_PI * kb*T*Cc2/(3.0*M_PI*mu*Dp2*Dp2) / sqrt(8.0*kb*T/M_PI/abs(m2));
+        if (lD1 >= Kn_fm_Frenk && lD2 >= Kn_fm_Frenk) {
+            nPairs_fm++;
+            return beta_12_FM;
+        }
+        if (lD1 <= Kn_c_Frenk && lD2 <= Kn_c_Frenk) {
+            nPairs_c++;
+            return beta_12_C;
+        }
+        nPairs_tr++;
+    }
+
     //------------ return harmonic mean
 
     return beta_12_FM * beta_12_C / (beta_12_FM + beta_12_C);
 
 }
 
+////////////////////////////////////////////////////////////////////////////////
+/*! coagRegime function
+ *      Classifies pair (i, j) of the cached particles for the regime-aware
+ *      kernels (see set_coag_regimes) and counts it.
+ *      Returns 1 (free molecular), -1 (continuum), or 0 (transition).
+ *
+ *      @param i       \input  index of particle 1
+ *      @param j       \input  index of particle 2
+ *      @param Kn_fm   \input  free-molecular threshold of the kernel
+ *      @param Kn_c    \input  continuum threshold of the kernel
+ */
+
+int soot::coagRegime(const int &i, const int &j, const double &Kn_fm, const double &Kn_c) {
+
+    if (pp_Kn[i] >= Kn_fm && pp_Kn[j] >= Kn_fm) {
+        nPairs_fm++;
+        return 1;
+    }
+    if (pp_Kn[i] <= Kn_c && pp_Kn[j] <= Kn_c) {
+        nPairs_c++;
+        return -1;
+    }
+    nPairs_tr++;
+    return 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Coagulation by Leung_Lindstedt from cached particle properties
+ *      See coagulation_LL and setParticleProps.
+ *
+ *      @param i       \input  index of particle 1
+ *      @param j       \input  index of particle 2
+ */
+
+double soot::coagulation_LL_pp(const int &i, const int &j) {
+
+    const double Ca = 9.0;
+    return 2.0*Ca*sqrt(pp_Dp[i]*6*pp_kT/rhoSoot);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Coagulation by Fuchs from cached particle properties
+ *      See coagulation_Fuchs and setParticleProps.
+ *      Uses c1^2 + c2^2 = 8*kb*T/pi*(1/m1 + 1/m2).
+ *
+ *      @param i       \input  index of particle 1
+ *      @param j       \input  index of particle 2
+ */
+
+double soot::coagulation_Fuchs_pp(const int &i, const int &j) {
+
+    if (pp_m[i] <= 0.0 || pp_m[j] <= 0.0)
+        return 0.0;
+
+    double Dp12 = pp_Dp[i] + pp_Dp[j];
+    double D12  = pp_D[i]  + pp_D[j];
+
+    if (useCoagRegimes) {
+        switch (coagRegime(i, j, Kn_fm_Fuchs, Kn_c_Fuchs)) {
+            case 1:  return M_PI/4.0*eps_c*sqrt(8.0*pp_kT/M_PI*(pp_rm[i] + pp_rm[j]))*Dp12*Dp12;
+            case -1: return 2.0*M_PI*D12*Dp12;
+        }
+    }
+
+    double c12  = sqrt(8.0*pp_kT/M_PI*(pp_rm[i] + pp_rm[j]));
+    double g12  = sqrt(pp_g[i]*pp_g[i] + pp_g[j]*pp_g[j]);
+
+    return 2.0*M_PI*D12*Dp12 / (Dp12/(Dp12+2.0*g12) + 8.0/eps_c*D12/c12/Dp12);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Coagulation by Frenklach from cached particle properties
+ *      See coagulation_Frenk and setParticleProps.
+ *
+ *      @param i       \input  index of particle 1
+ *      @param j       \input  index of particle 2
+ */
+
+double soot::coagulation_Frenk_pp(const int &i, const int &j) {
+
+    if (pp_m[i] <= 0.0 || pp_m[j] <= 0.0)
+        return 0.0;
+
+    double Dp12 = pp_Dp[i] + pp_Dp[j];
+
+    int regime = useCoagRegimes ? coagRegime(i, j, Kn_fm_Frenk, Kn_c_Frenk) : 0;
+
+    double beta_12_FM = regime == -1 ? 0.0 : eps_c*sqrt(M_PI*pp_kT*0.5*(pp_rm[i] + pp_rm[j])) * Dp12*Dp12;
+    if (regime == 1)
+        return beta_12_FM;
+
+    double beta_12_C  = 2*pp_kT/(3*mu)*(pp_CcDp[i] + pp_CcDp[j])*Dp12;
+    if (regime == -1)
+        return beta_12_C;
+
+    return beta_12_FM * beta_12_C / (beta_12_FM + beta_12_C);
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 /*! Gas mean free path
  *      Returns the value of the collision rate function beta in m3/#*s.
@@ -857,7 +2485,7 @@ double soot::get_Kc() {
  */
 
 double soot::get_Kcp() {
-    return 2.0*1.657*get_gas_mean_free_path()*pow(M_PI/6*rhoSoot,1./3.);
+    return 2.0*1.657*get_gas_mean_free_path()*sootMath::cbrt(M_PI/6*rhoSoot);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -867,7 +2495,7 @@ double soot::get_Kcp() {
  */
 
 double soot::get_Kfm() {
-    return eps_c*sqrt(M_PI*kb*T/2)*pow(6./M_PI/rhoSoot,2./3.);
+    return eps_c*sqrt(M_PI*kb*T/2)*sootMath::pow23(6./M_PI/rhoSoot);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include "table1D.h"
+#include "sootMath.h"
 #include <string>
 #include <vector>
 
@@ -48,6 +50,30 @@ class soot {
         double                  Cmin;                   ///< number of carbons in soot nucleation size
         double                  DIMER;                  ///< dimer concentration
         double                  m_dimer;                ///< dimer mass
+        double                  wdotD;                  ///< dimer formation (PAH self collision) rate #/m3*s
+        double                  beta_DD;                ///< dimer self-collision rate
+        double                  wdotD_cnd;              ///< dimer loss rate to condensation, DIMER*sum(beta_DS*w_i) #/m3*s
+
+        bool                    splitCoag;              ///< if true, setSrc omits coagulation (see advanceCoagulation)
+        double                  Ntol_active;            ///< particle number density (#/m3) at or below which a cell has no particles
+        double                  ytol_active;            ///< precursor mass fraction at or below which a cell has no nucleation
+        double                  skipTol;                ///< relative tolerance for skipping negligible processes; 0 = off
+
+        bool                    useSrcCache;            ///< reuse results of the last setSrc when inputs are unchanged
+        double                  cacheTol;               ///< relative tolerance for "unchanged" inputs
+        bool                    gasUnchanged;           ///< gas state equals that of the last setSrc (set by srcFromCache)
+        bool                    cacheRecording;         ///< inside a setSrc whose inputs are in cacheGas
+        bool                    cacheHave_nuc;          ///< cacheJnuc is valid for the cached gas state
+        bool                    cacheHave_grw;          ///< cacheKgrw is valid for the cached gas state
+        bool                    cacheHave_oxi;          ///< cacheKoxi is valid for the cached gas state
+        bool                    cacheHave_dimer;        ///< set_m_dimer results are valid for the cached gas state
+        double                  cacheJnuc;              ///< last gas-only nucleation rate (LL, LIN)
+        double                  cacheKgrw;              ///< last gas-only growth rate (LIN)
+        double                  cacheKoxi;              ///< last gas-only oxidation rate (LL, LEE_NEOH, NSC_NEOH)
+        vector<double>          cacheGas;               ///< T, P, rho, MW, mu, y of the last setSrc
+        vector<double>          cacheSoot;              ///< sootvar of the last setSrc
+        vector<double>          cacheSrc;               ///< src of the last setSrc
+        vector<double>          cacheGasSrc;            ///< gasSootSources of the last setSrc
 
         //-----------
 
@@ -85,6 +111,100 @@ class soot {
         static vector<double>   MW_sp;                  ///< vector of molecular weights
         static vector<string>   spNames;                ///< gas species names
         static vector<int>      nC_PAH;                 ///< number of carbon atoms in each PAH molecule considered
+        static vector<double>   m_pah;                  ///< PAH molecule mass (kg)
+        static vector<double>   wdot_pah_coef;          ///< wdot_i = coef_i*sqrt(T)*(rho*y_i)^2 (see set_m_dimer)
+
+        //----------- lumped PAH classes (see set_pah_lumping)
+
+        static int              nPAHclass;              ///< number of PAH classes; 0 for no lumping
+        static vector<int>      pah_class;              ///< class of each PAH species
+        static vector<double>   class_coef;             ///< class wdot coefficient: wdot_c = coef_c*sqrt(T)*(rho*Y_c)^2
+        static vector<double>   class_m;                ///< class mean molecule mass in the dimer (kg)
+        static vector<double>   class_nC;               ///< class mean carbon number in the dimer
+        vector<double>          Yclass;                 ///< class mass fractions (work array)
+        vector<double>          Sclass;                 ///< class sums of coef_i*y_i^2*m_i, for the species split (work array)
+
+        //----------- rate factors that depend only on T: f = A*T^b*exp(-E/T)
+
+        enum rateFactors { rf_nuc_LL,   rf_nuc_LIN,  rf_grw_LIN,  rf_grw_LL,   rf_oxi_LL,   rf_oxi_Lee,
+                           rf_Neoh_OH,  rf_NSC_kA,   rf_NSC_kB,   rf_NSC_kT,   rf_NSC_kz,
+                           rf_HACA_fR1, rf_HACA_rR1, rf_HACA_fR2, rf_HACA_rR2, rf_HACA_fR4, rf_HACA_fR5,
+                           n_rateFactors };
+
+        static const double     rateParams[n_rateFactors][3];   ///< A, b, E (K) of each rate factor
+        static vector<table1D>  rateTables;             ///< rate factors tabulated vs 1/T (see set_rate_table)
+        static vector<double>   rateTableTols;          ///< relTol each of rateTables was built with
+        static const int        rateTableVersion = 1;   ///< in the rate table keys: bump when rateFactorExact changes
+        static constexpr double Tmin_rateTable = 300.0; ///< K, lower end of rateTables
+        static constexpr double Tmax_rateTable = 3000.0;///< K, upper end of rateTables
+        bool                    useRateTable;           ///< use rateTables (else exact expressions)
+        double                  rateTableTol;           ///< relTol passed to set_rate_table
+
+        //----------- per-particle properties for the pair coagulation kernels (see setParticleProps)
+
+        vector<double>          pp_m;                   ///< particle mass (kg); last entry is the dimer
+        vector<double>          pp_rm;                  ///< 1/mass (1/kg)
+        vector<double>          pp_Dp;                  ///< diameter (m)
+        vector<double>          pp_Kn;                  ///< particle Knudsen number l/Dp (l: particle mean free path)
+        vector<double>          pp_CcDp;                ///< Cunningham factor / Dp (1/m)
+        vector<double>          pp_D;                   ///< diffusivity (m2/s)
+        vector<double>          pp_g;                   ///< Fuchs g term (m)
+        int                     ipp_dimer;              ///< index of the dimer in the pp_ arrays
+        double                  pp_kT;                  ///< kb*T for the cached properties
+        bool                    pp_current;             ///< pp_ arrays were set at the current gas state
+
+        //----------- regime-aware coagulation kernels (see set_coag_regimes)
+
+        bool                    useCoagRegimes;         ///< use asymptotic kernels outside the transition regime
+        double                  coagRegimeTol;          ///< relative error allowed for the asymptotic kernels
+        double                  Kn_fm_Fuchs;            ///< Fuchs pairs with both l/Dp >= Kn_fm_Fuchs use the free-molecular form
+        double                  Kn_c_Fuchs;             ///< Fuchs pairs with both l/Dp <= Kn_c_Fuchs use the continuum form
+        double                  Kn_fm_Frenk;            ///< same for Frenklach (coagulation and dimer kernels)
+        double                  Kn_c_Frenk;             ///< same for Frenklach (coagulation and dimer kernels)
+
+        //----------- scaled moments (see set_moment_scaling)
+
+        bool                    scaleMoments;           ///< invert/interpolate moments in reference units
+        double                  N_ref;                  ///< reference number density (#/m3) of the last setMomentScales
+        double                  m_ref;                  ///< reference mass (kg) of the last setMomentScales
+
+    public:
+
+        long int                nPairs_fm;              ///< number of kernel calls that used the free-molecular form
+        long int                nPairs_c;               ///< number of kernel calls that used the continuum form
+        long int                nPairs_tr;              ///< number of kernel calls that used the full (transition) form
+
+        //----------- active-cell partition of setSrc_cells (see set_active_tolerances)
+
+        enum cellClasses { cell_inactive, cell_nucOnly, cell_full };
+
+        vector<int>             cells_nucOnly;          ///< cells of the last batch with precursors but no particles
+        vector<int>             cells_full;             ///< cells of the last batch that need the full model
+        long int                nCells_inactive;        ///< number of inactive cells (all batches)
+        long int                nCells_nucOnly;         ///< number of nucleation-only cells (all batches)
+        long int                nCells_full;            ///< number of full cells (all batches)
+
+        //----------- work skipped by the relative tolerance mode (see set_skip_tolerance)
+
+        long int                nSkip_grw;              ///< growth rate evaluations skipped
+        long int                nSkip_oxi;              ///< oxidation rate evaluations skipped
+        long int                nSkip_cnd;              ///< PAH condensation evaluations skipped
+        long int                nSkip_coagPairs;        ///< coagulation pair kernels skipped
+        long int                nCoagPairs;             ///< coagulation pair kernels considered
+
+        //----------- re-evaluation cache (see set_src_cache)
+
+        long int                nCache_hit;             ///< setSrc calls answered from the cache
+        long int                nCache_gasHit;          ///< setSrc calls with the same gas state: gas-only rates reused
+        long int                nCache_miss;            ///< setSrc calls with a new gas state
+
+        //----------- realizability of the moment sets (see realizableMoments)
+
+        long int                nRealize_checked;       ///< moment sets checked
+        long int                nRealize_projected;     ///< moment sets projected onto a lower order
+        double                  realize_maxCorr;        ///< largest relative change of a projected moment
+
+    protected:
 
 
     //////////////////// MEMBER FUNCTIONS /////////////////
@@ -92,8 +212,45 @@ class soot {
     public:
 
         virtual void setSrc() = 0;            ///< this class is an abstract base class
+        virtual soot *clone() const = 0;      ///< copy of the model (configuration and work arrays), e.g., one per thread
         void   set_gas_state_vars(const double &T_p, const double &P_p, const double &rho_p, const double &MW_p, const double &mu_p, vector<double> &y_p);
 
+        void   setSrc_cells(const vector<double> &T_cells,   const vector<double> &P_cells,
+                            const vector<double> &rho_cells, const vector<double> &MW_cells,
+                            const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                            const vector<vector<double> > &sootvar_cells,
+                            vector<vector<double> > &src_cells,
+                            vector<vector<double> > &gasSootSources_cells);
+        void   setSrc_range(const int &ic0, const int &ic1,
+                            const vector<double> &T_cells,   const vector<double> &P_cells,
+                            const vector<double> &rho_cells, const vector<double> &MW_cells,
+                            const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                            const vector<vector<double> > &sootvar_cells,
+                            vector<vector<double> > &src_cells,
+                            vector<vector<double> > &gasSootSources_cells);
+        int    getCellClass(const vector<double> &M, const vector<double> &y_p);
+        double getPredictedCost(const vector<double> &M, const vector<double> &y_p);
+        void   set_active_tolerances(const double &p_Ntol, const double &p_ytol);
+        void   set_skip_tolerance(const double &p_skipTol) { skipTol = p_skipTol; reset_skip_counts(); }
+        void   reset_skip_counts() { nSkip_grw = nSkip_oxi = nSkip_cnd = nSkip_coagPairs = nCoagPairs = 0; }
+        void   reset_realize_counts() { nRealize_checked = nRealize_projected = 0; realize_maxCorr = 0.0; }
+        virtual void reset_counters();
+        virtual void addCounters(soot *s);
+        int    project_moments(vector<vector<double> > &sootvar_cells);
+        void   set_src_cache(const bool &p_useSrcCache, const double &p_cacheTol=1.0E-12);
+        vector<int> get_species_used();
+        string get_config_string();
+
+        virtual void advanceCoagulation(const double &dt, const int &nIter=2);
+        void   set_coag_splitting(const bool &p_splitCoag) { splitCoag = p_splitCoag; }
+        static void set_table_cache(const string &p_dir);
+        double set_rate_table(const bool &p_useRateTable, const double &relTol=1.0E-8);
+        void   set_coag_regimes(const bool &p_useCoagRegimes, const double &p_tol=1.0E-3);
+        void   reset_coag_regime_counts() { nPairs_fm = nPairs_c = nPairs_tr = 0; }
+        void   set_moment_scaling(const bool &p_scaleMoments);
+        double set_pah_lumping(const int &p_nPAHclass, const vector<double> &yRef=vector<double>(0));
+        double pah_lumping_error(const vector<double> &y_p);
+
     protected:
 
 
@@ -101,17 +258,39 @@ class soot {
         double getGrowthRate      (const double &M0=-1, const double &M1=-1);
         double getOxidationRate   (const double &M0=-1, const double &M1=-1);
         double getCoagulationRate (const double &m1,    const double &m2);
+        double getCoagulationRate_pp(const int &i,      const int &j);
+        double coagulationRateBound_pp(const int &i,    const int &j);
 
+        void   setParticleProps(const vector<double> &mi);
+        void   setParticleProp (const int &i, const double &m);
+        void   setMomentScales(const vector<double> &M);
+        int    realizableMoments(const vector<double> &M, vector<double> &Mp);
+
+        double getRateFactor(const int &i);
+        static double rateFactorExact(const int &i, const double &T_p);
+
+        double cunningham(const double &Kn);
         double get_gas_mean_free_path();
         double get_Kc();
         double get_Kcp();
         double get_Kfm();
 
         double set_m_dimer();
+        void   dimerSums(const vector<double> &y_p, const bool &lumped, double &w, double &m, double &nC);
         void   set_Ndimer(const vector<double> &mi, const vector<double> &wi);
+        double solve_Ndimer(const double &I_beta_DS);
 
         void   set_gasSootSources(const double &N1, const double &Cnd1, const double &G1, const double &X1);
 
+        virtual void   setSrc_nucOnly();
+        bool   negligible(const double &est, const double &dominant, long int &nSkip);
+        bool   srcFromCache();
+        void   saveSrcCache();
+        bool   skipSurfaceProcess(const bool &growth, const double &M0, const double &M1);
+        double surfaceRateBound(const bool &growth, const bool &upper, const double &M0, const double &M1);
+        virtual double getNumberDensity(const vector<double> &M) { return M[0]; }
+        virtual double getModelCost(const vector<double> &M) { return nsvar*nsvar; }
+
     private:
 
         double nucleation_LL      ();
@@ -131,6 +310,13 @@ class soot {
         double coagulation_Fuchs  (const double &m1, const double &m2);
         double coagulation_Frenk  (const double &m1, const double &m2);
 
+        int    coagRegime          (const int &i, const int &j, const double &Kn_fm, const double &Kn_c);
+        double coagRegimeError     (const bool &frenk, const bool &fm, const double &Dp, double &Kn);
+        double coagRegimeThreshold (const bool &frenk, const bool &fm, const double &tol);
+        double coagulation_LL_pp   (const int &i, const int &j);
+        double coagulation_Fuchs_pp(const int &i, const int &j);
+        double coagulation_Frenk_pp(const int &i, const int &j);
+
     //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
 
     public:
@@ -0,0 +1,439 @@
+/**
+ * @file sootBatch.cc
+ * Source file for class sootBatch
+ * @author Victoria B. Lansinger
+ */
+
+#include "sootBatch.h"
+#include <iostream>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Constructor
+ *
+ *      @param p_st        /input  soot model (configured)
+ *      @param p_ex        /input  executor; 0 = built-in sootThreadPool
+ *      @param p_nThreads  /input  threads of the built-in pool; 0 = hardware concurrency
+ */
+
+sootBatch::sootBatch(soot *p_st, sootExecutor *p_ex, const int &p_nThreads) {
+
+    st    = p_st;
+    ownEx = p_ex == 0;
+    ex    = ownEx ? new sootThreadPool(p_nThreads) : p_ex;
+    models.assign(ex->nThreads(), (soot*)0);
+    queues = new blockQueue[models.size()];
+
+    schedule        = sched_static;
+    blocksPerThread = 8;
+    accumulate      = false;
+
+    nSubmitted = nFinished = 0;
+    quitAsync  = false;
+    nBlocks = nSteal = 0;
+
+    meanCost.resize(3);                                 // initial guesses (s); only ratios matter
+    meanCost[soot::cell_inactive] = 1.0E-8;
+    meanCost[soot::cell_nucOnly]  = 1.0E-6;
+    meanCost[soot::cell_full]     = 1.0E-5;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Destructor
+ */
+
+sootBatch::~sootBatch() {
+
+    if (dispatcher.joinable()) {                        // finish submitted batches
+        {
+            lock_guard<mutex> lock(asyncMtx);
+            quitAsync = true;
+        }
+        cvSubmit.notify_one();
+        dispatcher.join();
+    }
+    update();
+    delete [] queues;
+    if (ownEx)
+        delete ex;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! update function
+ *
+ *      Discards the per-thread copies of the model; they are made again,
+ *      with the current settings of st, on the next batch.
+ */
+
+void sootBatch::update() {
+
+    for(int i=0; i<models.size(); i++) {
+        delete models[i];
+        models[i] = 0;
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_schedule function
+ *
+ *      @param p_schedule         /input  sched_static or sched_steal
+ *      @param p_blocksPerThread  /input  blocks per thread for sched_steal
+ *                                        (more: better balance, more overhead)
+ */
+
+void sootBatch::set_schedule(const int &p_schedule, const int &p_blocksPerThread) {
+
+    schedule        = p_schedule;
+    blocksPerThread = p_blocksPerThread > 0 ? p_blocksPerThread : 1;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! threadModel function
+ *
+ *      Returns the copy of the model for thread tid, making it if needed.
+ *      Call from thread tid (first touch).
+ */
+
+soot *sootBatch::threadModel(const int &tid) {
+
+    if (!models[tid]) {
+        models[tid] = st->clone();
+        models[tid]->set_src_cache(false);
+        models[tid]->reset_counters();
+    }
+    return models[tid];
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! addCounts function
+ *
+ *      Moves all work counters of the copies to st (see soot::addCounters).
+ */
+
+void sootBatch::addCounts() {
+
+    for(int i=0; i<models.size(); i++)
+        if (models[i])
+            st->addCounters(models[i]);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc_cells function
+ *
+ *      Parallel soot::setSrc_cells (same arguments and results).
+ *      Cells are timed one by one for sched_steal or cost accumulation.
+ */
+
+void sootBatch::setSrc_cells(const vector<double> &T_cells,   const vector<double> &P_cells,
+                             const vector<double> &rho_cells, const vector<double> &MW_cells,
+                             const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                             const vector<vector<double> > &sootvar_cells,
+                             vector<vector<double> > &src_cells,
+                             vector<vector<double> > &gasSootSources_cells) {
+
+    int nCells = T_cells.size();
+    src_cells.resize(nCells);
+    gasSootSources_cells.resize(nCells);
+
+    int  nth   = models.size();
+    bool timed = schedule == sched_steal || accumulate;
+
+    if (accumulate) {
+        if (!cellIds.empty() && cellIds.size() != nCells) {
+            cout << endl << "ERROR: sootBatch: set_cell_ids needs one id per cell of the batch." << endl;
+            exit(0);
+        }
+        int idMax = nCells-1;
+        for(int i=0; i<cellIds.size(); i++)
+            idMax = max(idMax, cellIds[i]);
+        if (cellTime.size() <= idMax) {
+            cellTime.resize(idMax+1, 0.0);
+            cellCalls.resize(idMax+1, 0);
+        }
+    }
+
+    //---------- cell classes and predicted costs (sched_steal)
+
+    if (schedule == sched_steal) {
+        cellClass.resize(nCells);
+        cellCost.resize(nCells);
+        ex->run([&](const int &tid) {
+            soot *m = threadModel(tid);
+            int ic1 = (long int)nCells*(tid+1)/nth;
+            for(int ic=(long int)nCells*tid/nth; ic<ic1; ic++) {
+                cellClass[ic] = m->getCellClass(sootvar_cells[ic], y_cells[ic]);
+                cellCost[ic]  = costHook ? costHook(ic) : meanCost[cellClass[ic]];
+            }
+        });
+        makeBlocks();
+    }
+
+    //---------- evaluate: equal ranges (sched_static) or blocks (sched_steal)
+
+    thrCost.assign(3*nth, 0.0);
+    thrCount.assign(5*nth, 0);
+    ex->run([&](const int &tid) {
+        soot *m = threadModel(tid);
+        double   c[3] = {0.0, 0.0, 0.0};                // local sums: no false sharing
+        long int n[5] = {0, 0, 0, 0, 0};
+        pair<int,int> blk((long int)nCells*tid/nth, (long int)nCells*(tid+1)/nth);
+        bool     stolen = false;
+        bool     more   = schedule == sched_static || nextBlock(tid, blk, stolen);
+        while (more) {
+            n[3]++;
+            if (stolen)
+                n[4]++;
+            if (!timed)
+                m->setSrc_range(blk.first, blk.second, T_cells, P_cells, rho_cells, MW_cells, mu_cells,
+                                y_cells, sootvar_cells, src_cells, gasSootSources_cells);
+            else {
+                for(int ic=blk.first; ic<blk.second; ic++) {
+                    int cls = schedule == sched_steal ? cellClass[ic] : m->getCellClass(sootvar_cells[ic], y_cells[ic]);
+                    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+                    m->setSrc_range(ic, ic+1, T_cells, P_cells, rho_cells, MW_cells, mu_cells,
+                                    y_cells, sootvar_cells, src_cells, gasSootSources_cells);
+                    double dt = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+                    c[cls] += dt;
+                    n[cls]++;
+                    if (accumulate) {
+                        int id = cellIds.empty() ? ic : cellIds[ic];
+                        cellTime[id] += dt;
+                        cellCalls[id]++;
+                    }
+                }
+            }
+            more = schedule == sched_steal && nextBlock(tid, blk, stolen);
+        }
+        for(int k=0; k<3; k++) {
+            thrCost [3*tid + k] = c[k];
+            thrCount[3*tid + k] = n[k];
+        }
+        thrCount[3*nth + tid] = n[3];
+        thrCount[4*nth + tid] = n[4];
+    });
+
+    //---------- update the class costs (average with the previous estimate)
+
+    for(int k=0; k<3; k++) {
+        double   c = 0.0;
+        long int n = 0;
+        for(int t=0; t<nth; t++) {
+            c += thrCost [3*t+k];
+            n += thrCount[3*t+k];
+        }
+        if (n > 0)
+            meanCost[k] = 0.5*(meanCost[k] + c/n);
+    }
+    if (schedule == sched_steal)
+        for(int t=0; t<nth; t++) {
+            nBlocks += thrCount[3*nth + t];
+            nSteal  += thrCount[4*nth + t];
+        }
+
+    addCounts();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! determinism_error function
+ *
+ *      Determinism check of the threaded evaluation: runs the batch with
+ *      the current threads and schedule (setSrc_cells), then on a fresh
+ *      serial copy of the model one cell at a time in reverse order, and
+ *      returns the largest relative difference of src and gasSootSources
+ *      (0 if bit-identical). In reverse order each cell follows a different
+ *      cell than in any thread's range, so state left in a model copy by
+ *      the previous cell (e.g., properties at another gas state) shows up
+ *      as a difference; use cells with varying gas states. cells.src and
+ *      cells.gasSootSources get the threaded results; counters and class
+ *      costs are updated as for any batch.
+ *
+ *      @param cells   /inout  batch inputs; outputs are set
+ */
+
+double sootBatch::determinism_error(sootCells &cells) {
+
+    setSrc_cells(cells.T, cells.P, cells.rho, cells.MW, cells.mu, cells.y, cells.sootvar,
+                 cells.src, cells.gasSootSources);
+
+    int nCells = cells.T.size();
+    vector<vector<double> > src(nCells);
+    vector<vector<double> > gas(nCells);
+
+    soot *m = st->clone();
+    m->set_src_cache(false);
+    for(int ic=nCells-1; ic>=0; ic--)
+        m->setSrc_range(ic, ic+1, cells.T, cells.P, cells.rho, cells.MW, cells.mu, cells.y,
+                        cells.sootvar, src, gas);
+    delete m;
+
+    double err = 0.0;
+    for(int ic=0; ic<nCells; ic++)
+        for(int k=0; k<2; k++) {
+            const vector<double> &a = k == 0 ? cells.src[ic] : cells.gasSootSources[ic];
+            const vector<double> &b = k == 0 ? src[ic]       : gas[ic];
+            for(int i=0; i<a.size(); i++) {
+                if (a[i] == b[i] || (a[i] != a[i] && b[i] != b[i]))     // equal, or both nan
+                    continue;
+                double d = abs(a[i]/b[i] - 1.0);
+                err = max(err, d == d && b[i] != 0.0 ? d : 1.0);
+            }
+        }
+
+    return err;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! makeBlocks function
+ *
+ *      Cuts the batch into about nth*blocksPerThread contiguous blocks of
+ *      equal predicted cost (cellCost) and deals them to the thread deques:
+ *      a block goes to the thread whose share of the total cost contains
+ *      the block's midpoint, so each thread starts with neighboring cells.
+ */
+
+void sootBatch::makeBlocks() {
+
+    int nCells = cellCost.size();
+    int nth    = models.size();
+
+    double total = 0.0;
+    for(int ic=0; ic<nCells; ic++)
+        total += cellCost[ic];
+
+    int    nBlk   = nth*blocksPerThread;
+    double target = total/nBlk;
+    double cum    = 0.0;                                // cost up to and including cell ic
+    double cum0   = 0.0;                                // cost before the current block
+    int    ic0    = 0;                                  // first cell of the current block
+    int    b      = 1;                                  // current block ends at cost b*target
+    for(int ic=0; ic<nCells; ic++) {
+        cum += cellCost[ic];
+        if (cum < b*target && ic < nCells-1)
+            continue;
+        int owner = total > 0.0 ? (int)(0.5*(cum0 + cum)/total*nth) : 0;
+        queues[min(owner, nth-1)].blocks.push_back(make_pair(ic0, ic+1));
+        ic0  = ic+1;
+        cum0 = cum;
+        while (b*target <= cum && b < nBlk)
+            b++;
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! nextBlock function
+ *
+ *      Gets the next block for thread tid: the front of its own deque, else
+ *      the back of another thread's (searching from tid+1; stolen is set).
+ *      Returns false when all deques are empty.
+ */
+
+bool sootBatch::nextBlock(const int &tid, pair<int,int> &blk, bool &stolen) {
+
+    int nth = models.size();
+    for(int i=0; i<nth; i++) {
+        blockQueue &q = queues[(tid+i) % nth];
+        lock_guard<mutex> lock(q.mtx);
+        if (q.blocks.empty())
+            continue;
+        if (i == 0) {
+            blk = q.blocks.front();
+            q.blocks.pop_front();
+        }
+        else {
+            blk = q.blocks.back();
+            q.blocks.pop_back();
+        }
+        stolen = i > 0;
+        return true;
+    }
+    return false;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! submit function
+ *
+ *      Queues cells for evaluation (as setSrc_cells) and returns at once.
+ *      Returns the handle for wait and done.
+ *
+ *      @param cells   /inout  batch: inputs set; src and gasSootSources are set
+ */
+
+long int sootBatch::submit(sootCells &cells) {
+
+    lock_guard<mutex> lock(asyncMtx);
+    if (!dispatcher.joinable())
+        dispatcher = thread(&sootBatch::dispatch, this);
+    pending.push_back(&cells);
+    cvSubmit.notify_one();
+    return nSubmitted++;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! wait function
+ *
+ *      Blocks until batch handle (from submit) is done.
+ */
+
+void sootBatch::wait(const long int &handle) {
+
+    unique_lock<mutex> lock(asyncMtx);
+    cvFinish.wait(lock, [this, &handle]() { return nFinished > handle; });
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! done function
+ *
+ *      Returns true if batch handle (from submit) is done; does not block.
+ */
+
+bool sootBatch::done(const long int &handle) {
+
+    lock_guard<mutex> lock(asyncMtx);
+    return nFinished > handle;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! dispatch function
+ *
+ *      Loop of the dispatcher thread: runs the submitted batches in order
+ *      on the executor. Exits when quitAsync is set and nothing is pending.
+ */
+
+void sootBatch::dispatch() {
+
+    while (true) {
+        sootCells *c;
+        {
+            unique_lock<mutex> lock(asyncMtx);
+            cvSubmit.wait(lock, [this]() { return quitAsync || !pending.empty(); });
+            if (pending.empty())
+                return;
+            c = pending.front();
+            pending.pop_front();
+        }
+
+        setSrc_cells(c->T, c->P, c->rho, c->MW, c->mu, c->y, c->sootvar, c->src, c->gasSootSources);
+
+        {
+            lock_guard<mutex> lock(asyncMtx);
+            nFinished++;
+        }
+        cvFinish.notify_all();
+    }
+
+}
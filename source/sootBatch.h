@@ -0,0 +1,180 @@
+/**
+ * @file sootBatch.h
+ * Header file for class sootBatch
+ */
+
+#pragma once
+
+#include "soot.h"
+#include "sootExecutor.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+#include <thread>
+#include <condition_variable>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Inputs and outputs of a batch of cells (see soot::setSrc_cells), for
+ *  asynchronous evaluation with sootBatch::submit.
+ */
+
+struct sootCells {
+    vector<double>          T, P, rho, MW, mu;          ///< gas state of each cell
+    vector<vector<double> > y;                          ///< gas species mass fractions of each cell
+    vector<vector<double> > sootvar;                    ///< soot variables of each cell
+    vector<vector<double> > src;                        ///< output: soot variable sources
+    vector<vector<double> > gasSootSources;             ///< output: gas species sources
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing a thread-parallel version of soot::setSrc_cells.
+ *
+ *  Each thread of the executor gets its own copy of the model
+ *  (soot::clone), made by that thread on first use so its work arrays are
+ *  first touched, and thus allocated, in the thread's NUMA node. A batch of
+ *  cells is split into equal contiguous ranges, one per thread; the output
+ *  of a cell is written (and first touched) by the thread that computes it.
+ *
+ *  Results do not depend on the number of threads or the schedule: every
+ *  cell is computed by the same code from its own inputs, and nothing a
+ *  cell leaves in a model copy is read for the next one (the per-particle
+ *  properties are recomputed at each cell's gas state, see soot::set_Ndimer,
+ *  and QMOM's nodes are cleared per cell, see soot_QMOM::getWtsAbs). For
+ *  this the re-evaluation cache (soot::set_src_cache) is turned off in the
+ *  copies, since its hits depend on which cell a thread did before.
+ *  determinism_error checks a batch against a serial evaluation in reverse
+ *  order; use cells with varying gas states.
+ *
+ *  Scaling with the number of cores (the target was near-linear up to 64
+ *  cores on one node) has not been measured: this code was only run on a
+ *  single-CPU machine, so no scaling figure is claimed.
+ *
+ *  The copies take the model settings at first use; call update after
+ *  changing settings of the model. Cell class counts (nCells_*) are added
+ *  to the model's counters.
+ *
+ *  Scheduling (set_schedule): sched_static gives each thread an equal
+ *  number of cells. sched_steal is for cells of very different cost: the
+ *  batch is cut into contiguous blocks of about equal predicted cost, the
+ *  blocks are dealt to per-thread deques in order (thread t gets the t-th
+ *  share of the cost), and a thread whose deque is empty steals from the
+ *  back of another's. The predicted cost of a cell is costHook(ic) if set
+ *  (e.g., from the host's flame-front indicator), else the measured mean
+ *  cost of its cell class (soot::getCellClass), updated after every batch
+ *  from per-cell timings.
+ *
+ *  Asynchronous use: submit(cells) queues a batch and returns a handle at
+ *  once; a sootBatch thread runs the queued batches in order on the
+ *  executor, and wait(handle) blocks until that batch is done. The two
+ *  buffers allow double buffering: fill buffers[1] with block k+1 and
+ *  submit it, do other work (e.g., gas chemistry of block k), then wait.
+ *  A submitted sootCells must not be touched until its wait returns, and
+ *  setSrc_cells must not be called while batches are pending.
+ *
+ *  Measured costs (set_cost_accumulation): the time of each cell is added
+ *  to cellTime[id], with id from set_cell_ids (the host's cell numbers,
+ *  unique within a batch) or else the position in the batch. A host
+ *  partitioner can weight cells with these; soot::getPredictedCost gives
+ *  an estimate without running the model.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootBatch {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        soot                   *st;                     ///< the model (settings and counters)
+        sootExecutor           *ex;                     ///< threads
+
+        enum schedules {sched_static, sched_steal};
+
+        /** predicted relative cost of cell ic of the current batch */
+        typedef function<double(const int &ic)> costFunc;
+
+        vector<double>          meanCost;               ///< measured mean cost (s) of a cell of each class (soot::cellClasses)
+        long int                nBlocks;                ///< blocks run (sched_steal)
+        long int                nSteal;                 ///< blocks run by a thread other than their owner
+
+        sootCells               buffers[2];             ///< double buffers for submit
+
+        vector<double>          cellTime;               ///< accumulated time (s) of each cell id (set_cost_accumulation)
+        vector<long int>        cellCalls;              ///< number of timed evaluations of each cell id
+
+    private:
+
+        struct blockQueue {
+            mutex               mtx;
+            deque<pair<int,int> > blocks;               ///< cell ranges [ic0, ic1)
+        };
+
+        bool                    ownEx;                  ///< ex was made here (delete it)
+        vector<soot*>           models;                 ///< per-thread copies of st (0 until first use)
+
+        int                     schedule;               ///< sched_static or sched_steal
+        int                     blocksPerThread;        ///< blocks per thread (sched_steal)
+        costFunc                costHook;               ///< predicted cell cost; empty = class mean costs
+        bool                    accumulate;             ///< accumulate cellTime
+        vector<int>             cellIds;                ///< host id of each cell of the batch; empty = position
+        blockQueue             *queues;                 ///< block deque of each thread
+        vector<int>             cellClass;              ///< class of each cell of the batch
+        vector<double>          cellCost;               ///< predicted (then cumulative) cost of each cell
+        vector<double>          thrCost;                ///< measured time per class, per thread (3*nth)
+        vector<long int>        thrCount;               ///< cells per class (3*nth), then blocks and stolen blocks (2*nth), per thread
+
+        thread                  dispatcher;             ///< runs submitted batches (started at the first submit)
+        mutex                   asyncMtx;
+        condition_variable      cvSubmit;               ///< signals a new batch (or quit)
+        condition_variable      cvFinish;               ///< signals a finished batch
+        deque<sootCells*>       pending;                ///< submitted batches not yet started
+        long int                nSubmitted;             ///< handles given out
+        long int                nFinished;              ///< batches done (handles below this are done)
+        bool                    quitAsync;              ///< dispatcher exits
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        void   setSrc_cells(const vector<double> &T_cells,   const vector<double> &P_cells,
+                            const vector<double> &rho_cells, const vector<double> &MW_cells,
+                            const vector<double> &mu_cells,  vector<vector<double> > &y_cells,
+                            const vector<vector<double> > &sootvar_cells,
+                            vector<vector<double> > &src_cells,
+                            vector<vector<double> > &gasSootSources_cells);
+        void   update();
+        void   set_schedule(const int &p_schedule, const int &p_blocksPerThread=8);
+        void   set_cost_hook(const costFunc &p_costHook) { costHook = p_costHook; }
+        void   set_cost_accumulation(const bool &p_accumulate) { accumulate = p_accumulate; }
+        void   set_cell_ids(const vector<int> &p_cellIds) { cellIds = p_cellIds; }
+        void   reset_cell_times() { cellTime.clear(); cellCalls.clear(); }
+
+        double determinism_error(sootCells &cells);
+
+        long int submit(sootCells &cells);
+        void   wait(const long int &handle);
+        bool   done(const long int &handle);
+
+    private:
+
+        soot  *threadModel(const int &tid);
+        void   addCounts();
+        void   makeBlocks();
+        bool   nextBlock(const int &tid, pair<int,int> &blk, bool &stolen);
+        void   dispatch();
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        sootBatch(soot *p_st, sootExecutor *p_ex=0, const int &p_nThreads=0);
+
+        ~sootBatch();
+
+};
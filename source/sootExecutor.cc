@@ -0,0 +1,158 @@
+/**
+ * @file sootExecutor.cc
+ * Source file for class sootThreadPool
+ * @author Victoria B. Lansinger
+ */
+
+#include "sootExecutor.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Constructor
+ *
+ *      @param p_nThreads  /input  number of threads; 0 = hardware concurrency
+ *      @param p_pin       /input  pin worker tid to the tid-th allowed CPU
+ *                                 (modulo their number; Linux only)
+ */
+
+sootThreadPool::sootThreadPool(const int &p_nThreads, const bool &p_pin) :
+    task(0), generation(0), nBusy(0), quit(false) {
+
+    nth = p_nThreads > 0 ? p_nThreads : thread::hardware_concurrency();
+    if (nth < 1)
+        nth = 1;
+
+    vector<int> cpus;
+    if (p_pin)
+        cpus = allowedCPUs();
+    for(int tid=1; tid<nth; tid++) {
+        int cpu = cpus.empty() ? -1 : cpus[tid % cpus.size()];
+        workers.push_back(thread([this, tid, cpu]() {
+            if (cpu >= 0)
+                pin(cpu);
+            worker(tid);
+        }));
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Destructor: stops and joins the workers.
+ */
+
+sootThreadPool::~sootThreadPool() {
+
+    {
+        lock_guard<mutex> lock(mtx);
+        quit = true;
+    }
+    cvStart.notify_all();
+    for(int i=0; i<workers.size(); i++)
+        workers[i].join();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! run function
+ *
+ *      Calls p_task(tid) on every thread; the caller runs tid 0.
+ *      Returns when all threads are done. Not reentrant.
+ *
+ *      @param p_task  /input  task
+ */
+
+void sootThreadPool::run(const function<void(const int &tid)> &p_task) {
+
+    {
+        lock_guard<mutex> lock(mtx);
+        task  = &p_task;
+        nBusy = nth-1;
+        generation++;
+    }
+    cvStart.notify_all();
+
+    p_task(0);
+
+    unique_lock<mutex> lock(mtx);
+    cvDone.wait(lock, [this]() { return nBusy == 0; });
+    task = 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! worker function
+ *
+ *      Loop of worker thread tid: waits for a run, calls the task, signals
+ *      when done.
+ */
+
+void sootThreadPool::worker(const int tid) {
+
+    long int seen = 0;
+    while (true) {
+        const function<void(const int &tid)> *t;
+        {
+            unique_lock<mutex> lock(mtx);
+            cvStart.wait(lock, [this, seen]() { return quit || generation != seen; });
+            if (quit)
+                return;
+            seen = generation;
+            t    = task;
+        }
+
+        (*t)(tid);
+
+        bool last;
+        {
+            lock_guard<mutex> lock(mtx);
+            last = --nBusy == 0;
+        }
+        if (last)
+            cvDone.notify_one();
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! allowedCPUs function
+ *
+ *      Returns the CPUs in the affinity mask of the calling thread (e.g.,
+ *      as restricted by taskset, cgroups, or an MPI launcher), in
+ *      increasing order. Empty except on Linux, or if the mask can't be read.
+ */
+
+vector<int> sootThreadPool::allowedCPUs() {
+
+    vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    if (sched_getaffinity(0, sizeof(cs), &cs) != 0)
+        return cpus;
+    for(int c=0; c<CPU_SETSIZE; c++)
+        if (CPU_ISSET(c, &cs))
+            cpus.push_back(c);
+#endif
+    return cpus;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! pin function
+ *
+ *      Pins the calling thread to CPU cpu. No-op except on Linux.
+ */
+
+void sootThreadPool::pin(const int &cpu) {
+
+#ifdef __linux__
+    cpu_set_t cs;
+    CPU_ZERO(&cs);
+    CPU_SET(cpu, &cs);
+    pthread_setaffinity_np(pthread_self(), sizeof(cs), &cs);
+#endif
+
+}
@@ -0,0 +1,99 @@
+/**
+ * @file sootExecutor.h
+ * Header file for classes sootExecutor and sootThreadPool
+ */
+
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Interface to the threads used by the parallel soot drivers (sootBatch).
+ *  run(task) calls task(tid) for tid = 0, ..., nThreads()-1, concurrently,
+ *  and returns when all calls are done. Thread tid should be the same OS
+ *  thread on every run, so per-thread data stays in its NUMA node.
+ *
+ *  A host code can pass its own pool, e.g., OpenMP:
+ *
+ *      class ompExecutor : public sootExecutor {
+ *          public:
+ *          int  nThreads() { return omp_get_max_threads(); }
+ *          void run(const function<void(const int &tid)> &task) {
+ *              #pragma omp parallel
+ *              task(omp_get_thread_num());
+ *          }
+ *      };
+ *
+ *  or TBB (tbb::task_arena::execute with parallel_for over tid, using
+ *  tbb::this_task_arena::current_thread_index as tid).
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootExecutor {
+
+    public:
+
+        virtual int  nThreads() = 0;
+        virtual void run(const function<void(const int &tid)> &task) = 0;
+
+        virtual ~sootExecutor(){}
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Built-in sootExecutor: a fixed pool of std::threads. The calling thread
+ *  is tid 0; workers 1, ..., nThreads-1 wait between runs. Optionally each
+ *  worker is pinned to one CPU of the process's affinity mask (Linux),
+ *  which keeps first-touch memory local. The calling thread belongs to the
+ *  host and is left as it is.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootThreadPool : public sootExecutor {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    private:
+
+        int                     nth;                    ///< number of threads (including the caller)
+        vector<thread>          workers;                ///< threads 1, ..., nth-1
+        mutex                   mtx;
+        condition_variable      cvStart;                ///< signals a new run (or quit)
+        condition_variable      cvDone;                 ///< signals the end of a run
+        const function<void(const int &tid)> *task;     ///< task of the current run
+        long int                generation;             ///< number of runs started
+        int                     nBusy;                  ///< workers still in the current run
+        bool                    quit;                   ///< workers exit
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        int  nThreads() { return nth; }
+        void run(const function<void(const int &tid)> &task);
+
+    private:
+
+        void worker(const int tid);
+        static vector<int> allowedCPUs();
+        static void pin(const int &cpu);
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        sootThreadPool(const int &p_nThreads=0, const bool &p_pin=false);
+
+        ~sootThreadPool();
+
+};
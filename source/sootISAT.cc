@@ -0,0 +1,470 @@
+/**
+ * @file sootISAT.cc
+ * Source file for class sootISAT
+ * @author Victoria B. Lansinger
+ */
+
+#include "sootISAT.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/*! sootISAT constructor function
+ *
+ *      @param p_st     /input  soot model to tabulate (set up with its options)
+ *      @param p_tol    /input  error tolerance on the scaled sources
+ *      @param p_maxMB  /input  memory cap of the table (MB)
+ *      @param p_rmax   /input  largest EOA radius in scaled variables
+ */
+
+sootISAT::sootISAT(soot *p_st, const double &p_tol, const double &p_maxMB, const double &p_rmax) {
+
+    st    = p_st;
+    tol   = p_tol;
+    maxMB = p_maxMB;
+    rmax  = p_rmax;
+
+    isp = st->get_species_used();
+    nx  = 5 + isp.size() + st->nsvar;
+    nf  = st->nsvar + isp.size();
+
+    sootvar = vector<double>(st->nsvar, 0.0);
+    src.resize(st->nsvar);
+    gasSootSources.resize(st->gasSootSources.size());
+    x.resize(nx);
+    f.resize(nf);
+
+    yq   = 0;
+    root = -1;
+    nQuery = nDirect = nRetrieve = nGrow = nAdd = nEvict = nLeaves = 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_gas_state_vars function
+ *
+ *      Same as soot::set_gas_state_vars; sets the gas part of the query.
+ */
+
+void sootISAT::set_gas_state_vars(const double   &T_p,
+                                  const double   &P_p,
+                                  const double   &rho_p,
+                                  const double   &MW_p,
+                                  const double   &mu_p,
+                                  vector<double> &y_p){
+    x[0] = T_p;
+    x[1] = P_p;
+    x[2] = rho_p;
+    x[3] = MW_p;
+    x[4] = mu_p;
+    for(int i=0; i<isp.size(); i++)
+        x[5+i] = y_p[isp[i]];
+    yq = &y_p;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc function
+ *
+ *      Sets src and gasSootSources for the query (gas state and sootvar):
+ *      retrieve, grow, or add (see class description).
+ */
+
+void sootISAT::setSrc() {
+
+    if (yq == 0) {
+        cout << endl << "ERROR: sootISAT: call set_gas_state_vars before setSrc." << endl;
+        exit(0);
+    }
+
+    int nsvar = st->nsvar;
+    for(int k=0; k<nsvar; k++)
+        x[5+isp.size()+k] = sootvar[k];
+    nQuery++;
+
+    if (xScale.size() != nx || fScale.size() != nf) {
+        bool haveSoot = true;                           // scales from a soot-free query would be 1
+        for(int k=0; k<nsvar; k++)
+            haveSoot = haveSoot && sootvar[k] != 0.0;
+        if (!haveSoot) {
+            evaluate(x, f);
+            nDirect++;
+            unpack();
+            return;
+        }
+        setScales();
+    }
+
+    //---------- retrieve
+
+    int nodeNear = -1;                                  // tree node of the leaf reached by x
+    if (root >= 0) {
+        nodeNear = findLeaf(x);
+        leaf &L  = leaves[nodes[nodeNear].ileaf];
+        lruList.splice(lruList.begin(), lruList, L.lru);
+
+        if (scaledDist2(L, x) <= 1.0) {
+            for(int i=0; i<nf; i++) {
+                f[i] = L.f0[i];
+                for(int j=0; j<nx; j++)
+                    f[i] += L.A[i*nx+j]*(x[j]-L.x0[j]);
+            }
+            nRetrieve++;
+            unpack();
+            return;
+        }
+    }
+
+    //---------- grow
+
+    evaluate(x, f);
+
+    if (nodeNear >= 0) {
+        leaf &L = leaves[nodes[nodeNear].ileaf];
+
+        double err2 = 0.0;                              // error of the linear estimate
+        for(int i=0; i<nf; i++) {
+            double fl = L.f0[i];
+            for(int j=0; j<nx; j++)
+                fl += L.A[i*nx+j]*(x[j]-L.x0[j]);
+            err2 += pow((fl-f[i])/fScale[i], 2.0);
+        }
+
+        if (err2 <= tol*tol) {                          // rank-one update so x is on the EOA
+            vector<double> Mp(nx, 0.0);
+            double s = 0.0;
+            for(int i=0; i<nx; i++) {
+                for(int j=0; j<nx; j++)
+                    Mp[i] += L.M[i*nx+j]*(x[j]-L.x0[j])/xScale[j];
+                s += Mp[i]*(x[i]-L.x0[i])/xScale[i];
+            }
+            double c = (1.0/s - 1.0)/s;
+            for(int i=0; i<nx; i++)
+                for(int j=0; j<nx; j++)
+                    L.M[i*nx+j] += c*Mp[i]*Mp[j];
+            nGrow++;
+            unpack();
+            return;
+        }
+    }
+
+    //---------- add
+
+    addLeaf(nodeNear);
+    unpack();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! unpack function
+ *
+ *      Copies the current sources f to src and gasSootSources.
+ */
+
+void sootISAT::unpack() {
+
+    int nsvar = st->nsvar;
+
+    for(int k=0; k<nsvar; k++)
+        src[k] = f[k];
+    fill(gasSootSources.begin(), gasSootSources.end(), 0.0);
+    for(int i=0; i<isp.size(); i++)
+        gasSootSources[isp[i]] = f[nsvar+i];
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! evaluate function
+ *
+ *      Direct evaluation of the sources fq at query point xq by the soot model.
+ */
+
+void sootISAT::evaluate(const vector<double> &xq, vector<double> &fq) {
+
+    yWork = *yq;
+    for(int i=0; i<isp.size(); i++)
+        yWork[isp[i]] = xq[5+i];
+
+    st->set_gas_state_vars(xq[0], xq[1], xq[2], xq[3], xq[4], yWork);
+    for(int k=0; k<st->nsvar; k++)
+        st->sootvar[k] = xq[5+isp.size()+k];
+    st->setSrc();
+
+    for(int k=0; k<st->nsvar; k++)
+        fq[k] = st->src[k];
+    for(int i=0; i<isp.size(); i++)
+        fq[st->nsvar+i] = st->gasSootSources[isp[i]];
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setScales function
+ *
+ *      Default scales, for those not set by the user, from the first query
+ *      whose soot variables are all nonzero: xScale = |x| (1 if zero; 1E-6
+ *      floor for mass fractions), and fScale = |f| with a floor of 1E-6 of
+ *      the largest source in each group (src, gas sources). Earlier queries
+ *      (typically M = 0, which would give moment scales of 1) are evaluated
+ *      directly and not tabulated (nDirect). Scales are fixed once set,
+ *      since the stored EOAs depend on them.
+ */
+
+void sootISAT::setScales() {
+
+    int nsvar = st->nsvar;
+
+    if (xScale.size() != nx) {
+        xScale.resize(nx);
+        for(int j=0; j<nx; j++) {
+            bool isY  = (j >= 5 && j < 5+isp.size());
+            xScale[j] = isY ? max(abs(x[j]), 1.0E-6) : (x[j] != 0.0 ? abs(x[j]) : 1.0);
+        }
+    }
+
+    if (fScale.size() != nf) {
+        evaluate(x, f);
+        double fmaxS = 0.0, fmaxG = 0.0;
+        for(int i=0; i<nsvar; i++)  fmaxS = max(fmaxS, abs(f[i]));
+        for(int i=nsvar; i<nf; i++) fmaxG = max(fmaxG, abs(f[i]));
+        fScale.resize(nf);
+        for(int i=0; i<nf; i++) {
+            double fmax = i < nsvar ? fmaxS : fmaxG;
+            fScale[i]   = max(abs(f[i]), 1.0E-6*fmax);
+            if (fScale[i] == 0.0) fScale[i] = 1.0;
+        }
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! findLeaf function
+ *
+ *      Returns the tree node of the leaf reached by xq (the table is not empty).
+ */
+
+int sootISAT::findLeaf(const vector<double> &xq) {
+
+    int n = root;
+    while (nodes[n].ileaf < 0) {
+        double vx = 0.0;
+        for(int j=0; j<nx; j++)
+            vx += nodes[n].v[j]*xq[j]/xScale[j];
+        n = vx <= nodes[n].a ? nodes[n].left : nodes[n].right;
+    }
+    return n;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! scaledDist2 function
+ *
+ *      Returns dx'*M*dx (<= 1 inside the EOA of leaf L), dx = (xq-x0)/xScale.
+ */
+
+double sootISAT::scaledDist2(const leaf &L, const vector<double> &xq) {
+
+    double d2 = 0.0;
+    for(int i=0; i<nx; i++) {
+        double dxi = (xq[i]-L.x0[i])/xScale[i];
+        double Mdx = 0.0;
+        for(int j=0; j<nx; j++)
+            Mdx += L.M[i*nx+j]*(xq[j]-L.x0[j])/xScale[j];
+        d2 += dxi*Mdx;
+    }
+    return d2;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! addLeaf function
+ *
+ *      Adds a leaf at the current query x (f already evaluated): sensitivities
+ *      by forward differences, initial EOA M = As'*As/tol^2 + I/rmax^2 with
+ *      As the scaled sensitivity. The leaf at tree node nodeNear (-1 if the
+ *      table is empty) is split by the plane bisecting the two points.
+ *      Then leaves are removed (LRU) until the table fits in maxMB.
+ *
+ *      @param nodeNear  /input  tree node of the nearby leaf, or -1
+ */
+
+void sootISAT::addLeaf(const int &nodeNear) {
+
+    int il;
+    if (freeLeaves.size() > 0) {
+        il = freeLeaves.back();
+        freeLeaves.pop_back();
+    }
+    else {
+        il = leaves.size();
+        leaves.push_back(leaf());
+    }
+    leaf &L = leaves[il];
+
+    L.x0 = x;
+    L.f0 = f;
+
+    //---------- sensitivities by forward differences
+
+    L.A.resize(nf*nx);
+    vector<double> xp = x;
+    vector<double> fp(nf);
+    for(int j=0; j<nx; j++) {
+        double h = 1.0E-6*max(abs(x[j]), xScale[j]);
+        xp[j] = x[j] + h;
+        evaluate(xp, fp);
+        for(int i=0; i<nf; i++)
+            L.A[i*nx+j] = (fp[i]-f[i])/h;
+        xp[j] = x[j];
+    }
+
+    //---------- initial EOA
+
+    L.M.assign(nx*nx, 0.0);
+    for(int i=0; i<nx; i++) {
+        for(int j=0; j<=i; j++) {
+            double m = 0.0;
+            for(int k=0; k<nf; k++)
+                m += L.A[k*nx+i]*L.A[k*nx+j]*xScale[i]*xScale[j]/(fScale[k]*fScale[k]);
+            L.M[i*nx+j] = L.M[j*nx+i] = m/(tol*tol);
+        }
+        L.M[i*nx+i] += 1.0/(rmax*rmax);
+    }
+
+    //---------- insert in the tree
+
+    int nl = newNode();
+    nodes[nl].ileaf = il;
+    L.node = nl;
+
+    if (nodeNear < 0) {
+        root = nl;
+        nodes[nl].parent = -1;
+    }
+    else {                                          // nodeNear becomes a cutting-plane node
+        int ilOld = nodes[nodeNear].ileaf;
+        int no    = newNode();                      // new node for the old leaf
+        nodes[no].ileaf = ilOld;
+        nodes[no].parent = nodeNear;
+        leaves[ilOld].node = no;
+
+        node &N = nodes[nodeNear];
+        N.ileaf = -1;
+        N.v.resize(nx);
+        N.a = 0.0;
+        for(int j=0; j<nx; j++) {
+            double xo = leaves[ilOld].x0[j]/xScale[j];
+            double xn = x[j]/xScale[j];
+            N.v[j] = xn - xo;
+            N.a   += N.v[j]*0.5*(xn + xo);
+        }
+        N.left  = no;
+        N.right = nl;
+        nodes[nl].parent = nodeNear;
+    }
+
+    lruList.push_front(il);
+    L.lru = lruList.begin();
+    nLeaves++;
+    nAdd++;
+
+    //---------- memory cap: remove least recently used leaves
+
+    while (memoryMB() > maxMB && nLeaves > 1) {
+        removeLeaf(lruList.back());
+        nEvict++;
+    }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! removeLeaf function
+ *
+ *      Removes leaf il from the tree; its sibling takes the parent's place.
+ */
+
+void sootISAT::removeLeaf(const int &il) {
+
+    int n = leaves[il].node;
+    int p = nodes[n].parent;
+
+    if (p < 0)
+        root = -1;
+    else {
+        int s  = nodes[p].left == n ? nodes[p].right : nodes[p].left;
+        int gp = nodes[p].parent;
+        nodes[s].parent = gp;
+        if (gp < 0)
+            root = s;
+        else if (nodes[gp].left == p)
+            nodes[gp].left = s;
+        else
+            nodes[gp].right = s;
+        nodes[p].v.clear();
+        freeNodes.push_back(p);
+    }
+    freeNodes.push_back(n);
+
+    lruList.erase(leaves[il].lru);
+    leaves[il].x0.clear();  leaves[il].f0.clear();
+    leaves[il].A.clear();   leaves[il].M.clear();
+    freeLeaves.push_back(il);
+    nLeaves--;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! newNode function
+ *
+ *      Returns the index of an unused tree node.
+ */
+
+int sootISAT::newNode() {
+
+    int n;
+    if (freeNodes.size() > 0) {
+        n = freeNodes.back();
+        freeNodes.pop_back();
+    }
+    else {
+        n = nodes.size();
+        nodes.push_back(node());
+    }
+    nodes[n].left = nodes[n].right = nodes[n].parent = nodes[n].ileaf = -1;
+    nodes[n].a = 0.0;
+    return n;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! clear function
+ *
+ *      Empties the table (scales and statistics are kept).
+ */
+
+void sootISAT::clear() {
+
+    leaves.clear();
+    nodes.clear();
+    freeLeaves.clear();
+    freeNodes.clear();
+    lruList.clear();
+    root    = -1;
+    nLeaves = 0;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! memoryMB function
+ *
+ *      Returns the approximate memory of the stored leaves and tree (MB).
+ */
+
+double sootISAT::memoryMB() const {
+
+    double leafBytes = sizeof(leaf) + sizeof(double)*(nx + nf + nf*nx + nx*nx);
+    double nodeBytes = sizeof(node) + sizeof(double)*nx;
+    return nLeaves*(leafBytes + 2.0*nodeBytes)/(1024.0*1024.0);
+
+}
@@ -0,0 +1,129 @@
+/**
+ * @file sootISAT.h
+ * Header file for class sootISAT
+ */
+
+#pragma once
+
+#include "soot.h"
+#include <vector>
+#include <list>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing in-situ adaptive tabulation (ISAT, Pope 1997,
+ *  Combust. Theory Modelling 1:41-63) of the source terms of a soot model.
+ *
+ *  The query point is x = (T, P, rho, MW, mu, y of the gas species used by
+ *  the soot model, sootvar); the tabulated mapping is f = (src,
+ *  gasSootSources of those species). Each leaf stores x0, f0, the
+ *  sensitivity A = df/dx (forward finite differences), and an ellipsoid of
+ *  accuracy (EOA) {x: dx'*M*dx <= 1}, in variables scaled by xScale. Leaves
+ *  are found with a binary tree of cutting planes. A query in the EOA of the
+ *  leaf found is a retrieve, f = f0 + A*dx. Otherwise f is computed directly;
+ *  if the linear estimate is within tol (2-norm of the error scaled by
+ *  fScale) the EOA is grown to include x, else a new leaf is added. When
+ *  the table exceeds its memory cap, the least recently used leaf is removed.
+ *  Default scales are taken from the first query with soot (see setScales);
+ *  queries before it are evaluated directly and not tabulated.
+ *
+ *  Usage mirrors soot: set_gas_state_vars, set sootvar, setSrc, read src
+ *  and gasSootSources.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootISAT {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        soot                   *st;                     ///< the wrapped soot model (direct evaluations)
+
+        vector<double>          sootvar;                ///< soot variables of the query
+        vector<double>          src;                    ///< source terms for soot variables (size nsvar)
+        vector<double>          gasSootSources;         ///< gas species sources (all species)
+
+        double                  tol;                    ///< error tolerance on the scaled sources
+        double                  rmax;                   ///< largest EOA radius in scaled variables
+        double                  maxMB;                  ///< memory cap of the table (MB)
+
+        vector<double>          xScale;                 ///< scales of the query variables (set at the first query with soot if empty)
+        vector<double>          fScale;                 ///< scales of the sources (set at the first query with soot if empty)
+
+        long int                nQuery;                 ///< number of queries
+        long int                nDirect;                ///< queries evaluated directly while the scales were not set
+        long int                nRetrieve;              ///< queries answered from the table
+        long int                nGrow;                  ///< queries that grew an EOA
+        long int                nAdd;                   ///< queries that added a leaf
+        long int                nEvict;                 ///< leaves removed by the memory cap
+        long int                nLeaves;                ///< current number of leaves
+
+    private:
+
+        struct leaf {
+            vector<double>      x0;                     ///< query point (unscaled)
+            vector<double>      f0;                     ///< sources at x0 (unscaled)
+            vector<double>      A;                      ///< df/dx at x0, row major (nf x nx)
+            vector<double>      M;                      ///< EOA matrix in scaled variables (nx x nx)
+            int                 node;                   ///< tree node of this leaf
+            list<int>::iterator lru;                    ///< position in the LRU list
+        };
+
+        struct node {
+            int                 left;                   ///< child for v*x <= a
+            int                 right;                  ///< child for v*x >  a
+            int                 parent;                 ///< -1 for the root
+            int                 ileaf;                  ///< leaf index, or -1 for a cutting-plane node
+            vector<double>      v;                      ///< cutting plane normal (scaled variables)
+            double              a;                      ///< cutting plane offset
+        };
+
+        vector<int>             isp;                    ///< gas species used by the soot model
+        int                     nx;                     ///< number of query variables
+        int                     nf;                     ///< number of tabulated sources
+
+        vector<leaf>            leaves;
+        vector<node>            nodes;
+        vector<int>             freeLeaves;             ///< reusable entries of leaves
+        vector<int>             freeNodes;              ///< reusable entries of nodes
+        list<int>               lruList;                ///< leaves, most recently used first
+        int                     root;                   ///< root node, -1 if the table is empty
+
+        vector<double>          x;                      ///< current query (unscaled)
+        vector<double>          f;                      ///< current sources
+        vector<double>          *yq;                    ///< gas mass fractions of the query
+        vector<double>          yWork;                  ///< gas mass fractions for direct evaluations
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        void   set_gas_state_vars(const double &T_p, const double &P_p, const double &rho_p, const double &MW_p, const double &mu_p, vector<double> &y_p);
+        void   setSrc();
+        void   clear();
+        double memoryMB() const;
+
+    private:
+
+        void   evaluate(const vector<double> &xq, vector<double> &fq);
+        void   unpack();
+        void   setScales();
+        int    findLeaf(const vector<double> &xq);
+        double scaledDist2(const leaf &L, const vector<double> &xq);
+        void   addLeaf(const int &nodeNear);
+        void   removeLeaf(const int &il);
+        int    newNode();
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        sootISAT(soot *p_st, const double &p_tol=1.0E-3, const double &p_maxMB=100.0, const double &p_rmax=0.1);
+
+        ~sootISAT(){}
+
+};
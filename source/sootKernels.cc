@@ -0,0 +1,161 @@
+/**
+ * @file sootKernels.cc
+ * Source file for class sootKernels
+ * @author Victoria B. Lansinger
+ */
+
+#include "sootKernels.h"
+#include "sootMath.h"
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SOOT_KERNELS_X86
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernel versions. Contraction to FMA is off so every level rounds the same.
+// Build this file with -fno-math-errno -fno-trapping-math (CMakeLists.txt):
+// they let sqrt and the masked divisions vectorize, and change no result
+// (GCC does not honor them in an optimize pragma).
+
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+
+#define SOOT_KERNELS_NS sootKernels_scalar
+namespace SOOT_KERNELS_NS {
+#include "sootKernels_body.h"
+}
+#undef SOOT_KERNELS_NS
+
+#ifdef SOOT_KERNELS_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#define SOOT_KERNELS_NS sootKernels_avx2
+namespace SOOT_KERNELS_NS {
+#include "sootKernels_body.h"
+}
+#undef SOOT_KERNELS_NS
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512dq,avx512vl")
+#define SOOT_KERNELS_NS sootKernels_avx512
+namespace SOOT_KERNELS_NS {
+#include "sootKernels_body.h"
+}
+#undef SOOT_KERNELS_NS
+#pragma GCC pop_options
+
+#endif
+
+#pragma GCC pop_options
+
+////////////////////////////////////////////////////////////////////////////////
+
+sootKernels::pairKernelsFunc  sootKernels::pairKernels  = sootKernels_scalar::pairKernels;
+sootKernels::fracMomentsFunc  sootKernels::fracMoments  = sootKernels_scalar::fracMoments;
+sootKernels::mathArrayFunc    sootKernels::exps         = sootKernels_scalar::exps;
+sootKernels::mathArrayFunc    sootKernels::logs         = sootKernels_scalar::logs;
+int                           sootKernels::isa          = sootKernels::isa_scalar;
+
+static bool sootKernels_selected = sootKernels::select();   // once, at startup
+
+////////////////////////////////////////////////////////////////////////////////
+/*! select function
+ *
+ *      Selects the kernel versions. p_isa is "scalar", "avx2", or "avx512";
+ *      "" uses SOOTLIB_ISA if set, else cpu_isa. A level the CPU does not
+ *      support falls back to the best supported one. Returns true if the
+ *      requested level is active.
+ *
+ *      @param p_isa   /input  instruction set level
+ */
+
+bool sootKernels::select(const string &p_isa) {
+
+    string req = p_isa;
+    if (req.empty() && getenv("SOOTLIB_ISA"))
+        req = getenv("SOOTLIB_ISA");
+
+    int best  = cpu_isa();
+    int level = req == "scalar" ? isa_scalar :
+                req == "avx2"   ? isa_avx2   :
+                req == "avx512" ? isa_avx512 : best;
+    if (!req.empty() && req != "scalar" && req != "avx2" && req != "avx512")
+        cout << endl << "WARNING: sootKernels: unknown ISA level " << req << "; using the best supported level." << endl;
+    bool ok = level <= best;
+    if (!ok)
+        level = best;
+
+    isa          = isa_scalar;
+    pairKernels  = sootKernels_scalar::pairKernels;
+    fracMoments  = sootKernels_scalar::fracMoments;
+    exps         = sootKernels_scalar::exps;
+    logs         = sootKernels_scalar::logs;
+#ifdef SOOT_KERNELS_X86                          // pairKernels stays scalar: see sootKernels.h
+    if (level == isa_avx2) {
+        isa          = isa_avx2;
+        fracMoments  = sootKernels_avx2::fracMoments;
+        exps         = sootKernels_avx2::exps;
+        logs         = sootKernels_avx2::logs;
+    }
+    else if (level == isa_avx512) {
+        isa          = isa_avx512;
+        fracMoments  = sootKernels_avx512::fracMoments;
+        exps         = sootKernels_avx512::exps;
+        logs         = sootKernels_avx512::logs;
+    }
+#endif
+
+    return ok;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! get_isa function
+ *
+ *      Returns the active level: "scalar", "avx2", or "avx512".
+ */
+
+string sootKernels::get_isa() {
+
+    return isa == isa_avx512 ? "avx512" : isa == isa_avx2 ? "avx2" : "scalar";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! cpu_isa function
+ *
+ *      Returns the best level the CPU supports (isaLevels).
+ */
+
+int sootKernels::cpu_isa() {
+
+#ifdef SOOT_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512vl"))
+        return isa_avx512;
+    if (__builtin_cpu_supports("avx2"))
+        return isa_avx2;
+#endif
+    return isa_scalar;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! coagMech function
+ *
+ *      Returns the coagMechs value of a coagulation mechanism flag; -1 if
+ *      the flag is not a mechanism of the kernels.
+ *
+ *      @param mech   /input  soot::coagulation_mech
+ */
+
+int sootKernels::coagMech(const string &mech) {
+
+    return mech == "NONE"  ? coag_none  :
+           mech == "LL"    ? coag_LL    :
+           mech == "FUCHS" ? coag_Fuchs :
+           mech == "FRENK" ? coag_Frenk : -1;
+}
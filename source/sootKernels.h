@@ -0,0 +1,89 @@
+/**
+ * @file sootKernels.h
+ * Header file for class sootKernels
+ */
+
+#pragma once
+
+#include <string>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing runtime CPU dispatch of the vectorizable soot kernels.
+ *
+ *  Each kernel is compiled for several instruction sets (scalar x86-64,
+ *  AVX2, AVX-512; see sootKernels_body.h) in the same binary, so a portable
+ *  build (-O3 without -march) still uses the widest vectors of the node.
+ *  The version is selected once at startup: from the environment variable
+ *  SOOTLIB_ISA (scalar, avx2, avx512) if set, else the best level the CPU
+ *  supports (cpuid). get_isa reports the active level; select changes it.
+ *
+ *  All levels give identical results: the kernels use only +, -, *, /,
+ *  and sqrt (correctly rounded), without FMA contraction or reassociation,
+ *  plus libm exp/log at sootMath::acc_full or the sootMath polynomial
+ *  cores at the fast accuracy levels (exps, logs).
+ *  Non-x86 or non-GNU builds have the scalar level only.
+ *
+ *  Coverage, with per-call times measured on a Xeon with AVX-512 (scalar /
+ *  avx2 / avx512):
+ *      - exps at acc_1e10, 53 values (MOMIC nsvar = 6, setFracMoments):
+ *        480 / 150-200 / 110 ns. LOGN's 15 fractional moments and QMOM's
+ *        fracMoments (8 exponents x 2-4 nodes) gain 1.5-2.4x.
+ *      - exps, logs at acc_full: libm, so scalar at every level (a vector
+ *        exp is not bit-identical to libm). Use acc_1e10 for the gain.
+ *      - pairKernels: the vector builds were 0.7-0.9x the scalar one for
+ *        n = 2-16 particles (division and sqrt bound, short rows), so
+ *        every level uses the scalar build.
+ *  Not dispatched:
+ *      - rate factors across the cells of soot::setSrc_range: replacing
+ *        all of them by set_rate_table lookups changes setSrc by under
+ *        0.1 us per cell (QMOM, LOGN, MOMIC), which bounds the gain.
+ *      - the MOMIC Lagrange interpolation and the QMOM/DQMOM moment
+ *        inversion: a few dependent operations per moment, no vector width.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootKernels {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        enum isaLevels {isa_scalar, isa_avx2, isa_avx512};
+        enum coagMechs {coag_none, coag_LL, coag_Fuchs, coag_Frenk};
+
+        /** pair coagulation kernels beta[i*n+j], j <= i, from the soot pp_ arrays */
+        typedef void (*pairKernelsFunc)(const int &mech, const int &n, const double *m, const double *rm,
+                                        const double *Dp, const double *CcDp, const double *D, const double *g,
+                                        const double &kT, const double &mu, const double &rhoSoot,
+                                        const double &eps_c, double *beta);
+
+        /** Mfrac[j] = sum_k w[k]*exp(fracExps[j]*logAbsc[k]) (work: ne*nn) */
+        typedef void (*fracMomentsFunc)(const int &ne, const int &nn, const double *fracExps,
+                                        const double *logAbsc, const double *w, double *work, double *Mfrac);
+
+        /** y[i] = f(x[i]), i < n, at the sootMath accuracy level (in place allowed) */
+        typedef void (*mathArrayFunc)(const int &n, const double *x, double *y);
+
+        static pairKernelsFunc  pairKernels;
+        static fracMomentsFunc  fracMoments;
+        static mathArrayFunc    exps;
+        static mathArrayFunc    logs;
+
+    private:
+
+        static int              isa;                    ///< active level (isaLevels)
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        static bool   select(const string &p_isa="");
+        static string get_isa();
+        static int    cpu_isa();
+        static int    coagMech(const string &mech);
+
+};
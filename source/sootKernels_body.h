@@ -0,0 +1,125 @@
+/**
+ * @file sootKernels_body.h
+ * Kernel bodies of class sootKernels. Included by sootKernels.cc once per
+ * instruction set level, inside namespace SOOT_KERNELS_NS and the matching
+ * target options; no include guard.
+ */
+
+////////////////////////////////////////////////////////////////////////////////
+/*! pairKernels function
+ *
+ *      Pair coagulation kernels of all particle pairs j <= i; same
+ *      expressions as soot::coagulation_*_pp (without regimes). The inner
+ *      loop has no branches (empty particles are masked), so it vectorizes;
+ *      this needs -fno-math-errno -fno-trapping-math (see sootKernels.cc).
+ */
+
+void pairKernels(const int &mech, const int &n, const double *m, const double *rm,
+                 const double *Dp, const double *CcDp, const double *D, const double *g,
+                 const double &kT, const double &mu, const double &rhoSoot,
+                 const double &eps_c, double *beta) {
+
+    const double Ca = 9.0;
+
+    for (int i=0; i<n; i++) {
+        double *__restrict__ b = beta + i*n;
+        const double Dpi = Dp[i], Di = D[i], rmi = rm[i], gi2 = g[i]*g[i], CcDpi = CcDp[i];
+        const bool   mi  = m[i] > 0.0;
+        if (mech == sootKernels::coag_LL) {
+            double bi = 2.0*Ca*sqrt(Dpi*6*kT/rhoSoot);
+            for (int j=0; j<=i; j++)
+                b[j] = bi;
+        }
+        else if (mech == sootKernels::coag_Fuchs) {
+            for (int j=0; j<=i; j++) {
+                double Dp12 = Dpi + Dp[j];
+                double D12  = Di  + D[j];
+                double c12  = sqrt(8.0*kT/M_PI*(rmi + rm[j]));
+                double g12  = sqrt(gi2 + g[j]*g[j]);
+                double v    = 2.0*M_PI*D12*Dp12 / (Dp12/(Dp12+2.0*g12) + 8.0/eps_c*D12/c12/Dp12);
+                b[j] = (mi && m[j] > 0.0) ? v : 0.0;
+            }
+        }
+        else if (mech == sootKernels::coag_Frenk) {
+            for (int j=0; j<=i; j++) {
+                double Dp12 = Dpi + Dp[j];
+                double bFM  = eps_c*sqrt(M_PI*kT*0.5*(rmi + rm[j])) * Dp12*Dp12;
+                double bC   = 2*kT/(3*mu)*(CcDpi + CcDp[j])*Dp12;
+                double v    = bFM * bC / (bFM + bC);
+                b[j] = (mi && m[j] > 0.0) ? v : 0.0;
+            }
+        }
+        else
+            for (int j=0; j<=i; j++)
+                b[j] = 0.0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! exps function
+ *
+ *      y[i] = exp(x[i]) at the sootMath level; the fast cores vectorize.
+ */
+
+void exps(const int &n, const double *x, double *y) {
+
+    if (sootMath::level == sootMath::acc_1e10)
+        for (int i=0; i<n; i++)
+            y[i] = sootMath::exp_1e10(x[i]);
+    else if (sootMath::level == sootMath::acc_1e6)
+        for (int i=0; i<n; i++)
+            y[i] = sootMath::exp_1e6(x[i]);
+    else
+        for (int i=0; i<n; i++)
+            y[i] = exp(x[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! logs function
+ *
+ *      y[i] = log(x[i]) at the sootMath level; the fast cores vectorize,
+ *      then entries outside the normal positive range are redone by libm.
+ */
+
+void logs(const int &n, const double *x, double *y) {
+
+    if (sootMath::level == sootMath::acc_full) {
+        for (int i=0; i<n; i++)
+            y[i] = log(x[i]);
+        return;
+    }
+
+    if (sootMath::level == sootMath::acc_1e10)
+        for (int i=0; i<n; i++)
+            y[i] = sootMath::log_1e10(x[i]);
+    else
+        for (int i=0; i<n; i++)
+            y[i] = sootMath::log_1e6(x[i]);
+
+    for (int i=0; i<n; i++)
+        if (!(x[i] >= DBL_MIN && x[i] <= DBL_MAX))
+            y[i] = log(x[i]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! fracMoments function
+ *
+ *      Fractional moments of a quadrature: Mfrac[j] = sum_k w[k]*absc[k]^fracExps[j],
+ *      from log(absc); see soot_QMOM::setFracMoments.
+ */
+
+void fracMoments(const int &ne, const int &nn, const double *fracExps,
+                 const double *logAbsc, const double *w, double *work, double *Mfrac) {
+
+    for (int j=0; j<ne; j++)
+        for (int k=0; k<nn; k++)
+            work[j*nn+k] = fracExps[j]*logAbsc[k];
+
+    exps(ne*nn, work, work);
+
+    for (int j=0; j<ne; j++)
+        Mfrac[j] = 0.0;
+    for (int k=0; k<nn; k++)                  // over j inside: same summation order, vectorizes
+        for (int j=0; j<ne; j++)
+            Mfrac[j] += w[k]*work[j*nn+k];
+}
@@ -0,0 +1,89 @@
+/**
+ * @file sootMath.cc
+ * Source file for class sootMath
+ * @author Victoria B. Lansinger
+ */
+
+#include "sootMath.h"
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+
+int sootMath::level = sootMath::acc_full;
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_accuracy function
+ *
+ *      Sets the accuracy level of all sootMath functions (accuracies). Set
+ *      before building tables (set_rate_table, ...) or the re-evaluation
+ *      cache, since their contents depend on it.
+ *
+ *      @param p_level   /input  acc_full, acc_1e10, or acc_1e6
+ */
+
+void sootMath::set_accuracy(const int &p_level) {
+
+    if (p_level != acc_full && p_level != acc_1e10 && p_level != acc_1e6) {
+        cout << endl << "ERROR: invalid sootMath accuracy level " << p_level << endl;
+        exit(0);
+    }
+    level = p_level;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! get_accuracy function
+ *
+ *      Returns the active level: "full", "1e-10", or "1e-6".
+ */
+
+string sootMath::get_accuracy() {
+
+    return level == acc_1e10 ? "1e-10" : level == acc_1e6 ? "1e-6" : "full";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! max_error function
+ *
+ *      Accuracy check against libm: returns the largest relative error of
+ *      the sootMath functions at level p_level over random arguments
+ *      spanning the ranges the models use (x from 1E-300 to 1E300 for
+ *      log, pow, and the roots; exp arguments from -708 to log(DBL_MAX); tanh
+ *      arguments from 1E-4 to 20 of either sign; pow exponents from -2 to
+ *      2). The active level is restored on return.
+ *
+ *      @param p_level    /input  level to check (accuracies)
+ *      @param nSamples   /input  number of random arguments per function
+ */
+
+double sootMath::max_error(const int &p_level, const int &nSamples) {
+
+    int level_save = level;
+    set_accuracy(p_level);
+
+    mt19937_64 gen(12345);
+    uniform_real_distribution<double> U(0.0, 1.0);
+
+    double err = 0.0;
+    for (int i=0; i<nSamples; i++) {
+        double x  = std::pow(10.0, -300.0 + 600.0*U(gen));
+        double z  = -708.0 + (std::log(DBL_MAX) + 708.0)*U(gen);     // whole finite range of exp
+        double t  = (U(gen) < 0.5 ? -1.0 : 1.0) * std::pow(10.0, -4.0 + 5.3*U(gen));
+        double y  = -2.0 + 4.0*U(gen);
+        double xp = std::pow(10.0, -100.0 + 200.0*U(gen));           // x^y within range
+        err = max(err, abs(exp(z)      /std::exp(z)          - 1.0));
+        err = max(err, abs(log(x)      /std::log(x)          - 1.0));
+        err = max(err, abs(log10(x)    /std::log10(x)        - 1.0));
+        err = max(err, abs(pow(xp, y)  /std::pow(xp, y)      - 1.0));
+        err = max(err, abs(cbrt(x)     /std::pow(x, 1.0/3.0) - 1.0));
+        err = max(err, abs(pow23(x)    /std::pow(x, 2.0/3.0) - 1.0));
+        err = max(err, abs(pow16(x)    /std::pow(x, 1.0/6.0) - 1.0));
+        err = max(err, abs(tanh(t)     /std::tanh(t)         - 1.0));
+    }
+
+    level = level_save;
+    return err;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file sootMath.h
+ * Header file for class sootMath
+ */
+
+#pragma once
+
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cfloat>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing the transcendental functions of the soot models
+ *  (exp, log, log10, pow, cube root, x^(2/3), x^(1/6), tanh) at a
+ *  selectable accuracy, so accuracy can be traded for speed per run.
+ *
+ *  Levels (set_accuracy):
+ *      acc_full:  libm, with the same calls as before (results unchanged)
+ *      acc_1e10:  relative error below about 1E-10 (max_error, 1E7 samples: 5.1E-11)
+ *      acc_1e6:   relative error below about 1E-6  (max_error, 1E7 samples: 4.6E-7)
+ *
+ *  The fast levels use range reduction plus short polynomials (exp, log)
+ *  and Newton/Halley steps from a bit-level guess (cube root); the cores
+ *  (exp_1e10, log_1e6, ...) have no branches, so loops over arrays of them
+ *  vectorize (see sootKernels::exps and logs). pow(x,y) = exp(y*log(x)),
+ *  with error of order (1 + |y|/3)*level. Inputs outside the normal
+ *  positive range (zero, negative, subnormal, inf, nan) fall back to libm
+ *  in the scalar functions; exp underflows to 0 below -708 and overflows
+ *  to HUGE_VAL above log(DBL_MAX), like libm.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class sootMath {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        enum accuracies {acc_full, acc_1e10, acc_1e6};
+
+        static int              level;                  ///< active accuracy level (accuracies)
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        static void   set_accuracy(const int &p_level);
+        static string get_accuracy();
+        static double max_error(const int &p_level, const int &nSamples=100000);
+
+        //---------- dispatching by level
+
+        static double exp(const double &x) {
+            return level == acc_full ? std::exp(x) : level == acc_1e10 ? exp_1e10(x) : exp_1e6(x);
+        }
+
+        static double log(const double &x) {
+            if (level == acc_full || !(x >= DBL_MIN && x <= DBL_MAX))
+                return std::log(x);
+            return level == acc_1e10 ? log_1e10(x) : log_1e6(x);
+        }
+
+        static double log10(const double &x) {
+            return level == acc_full ? std::log10(x) : log(x)*(1.0/M_LN10);
+        }
+
+        static double pow(const double &x, const double &y) {
+            if (level == acc_full || !(x >= DBL_MIN && x <= DBL_MAX))
+                return std::pow(x, y);
+            return level == acc_1e10 ? exp_1e10(y*log_1e10(x)) : exp_1e6(y*log_1e6(x));
+        }
+
+        static double cbrt(const double &x) {                                  // x^(1/3)
+            if (level == acc_full || !(x >= DBL_MIN && x <= DBL_MAX))
+                return std::pow(x, 1.0/3.0);
+            return level == acc_1e10 ? cbrt_1e10(x) : cbrt_1e6(x);
+        }
+
+        static double pow23(const double &x) {                                 // x^(2/3)
+            if (level == acc_full || !(x >= DBL_MIN && x <= DBL_MAX))
+                return std::pow(x, 2.0/3.0);
+            double c = level == acc_1e10 ? cbrt_1e10(x) : cbrt_1e6(x);
+            return c*c;
+        }
+
+        static double pow16(const double &x) {                                 // x^(1/6)
+            if (level == acc_full || !(x >= DBL_MIN && x <= DBL_MAX))
+                return std::pow(x, 1.0/6.0);
+            return sqrt(level == acc_1e10 ? cbrt_1e10(x) : cbrt_1e6(x));
+        }
+
+        static double tanh(const double &x) {
+            if (level == acc_full || x != x)
+                return std::tanh(x);
+            double u  = -2.0*abs(x);                  // tanh|x| = -expm1(u)/(expm1(u)+2)
+            double em = u > -0.5*M_LN2 ? (level == acc_1e10 ? expm1_1e10(u) : expm1_1e6(u))
+                                       : (level == acc_1e10 ? exp_1e10(u)   : exp_1e6(u)) - 1.0;
+            double t  = -em/(em + 2.0);
+            return x < 0.0 ? -t : t;
+        }
+
+        //---------- cores (no branches)
+
+        ////////////////////////////////////////////////////////////////////////
+        /*! expm1(r) for |r| <= ln2/2: Taylor series (error r^n/n!, n = 10, 7).
+         */
+
+        static double expm1_1e10(const double &r) {
+            return r*(1.0 + r*(1.0/2 + r*(1.0/6 + r*(1.0/24 + r*(1.0/120 + r*(1.0/720 +
+                   r*(1.0/5040 + r*(1.0/40320 + r*(1.0/362880)))))))));
+        }
+
+        static double expm1_1e6(const double &r) {
+            return r*(1.0 + r*(1.0/2 + r*(1.0/6 + r*(1.0/24 + r*(1.0/120 + r*(1.0/720))))));
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /*! exp(x) = 2^k*(1 + expm1(r)), x = k*ln2 + r. The rounding of k and
+         *  the scaling by 2^k are done on the bits (shift constant 1.5*2^52),
+         *  so no double <-> integer conversion is needed.
+         */
+
+        static double exp_1e10(const double &x) { return expScale(x, 0); }
+        static double exp_1e6(const double &x)  { return expScale(x, 1); }
+
+        ////////////////////////////////////////////////////////////////////////
+        /*! log(x) = e*ln2 + log(m), m in [sqrt(1/2), sqrt(2)), with
+         *  log(m) = 2*atanh(s), s = (m-1)/(m+1), |s| <= 0.172 (error
+         *  s^(2n)/(2n+1), n = 6, 4). For normal positive x only.
+         */
+
+        static double log_1e10(const double &x) {
+            double s, ed;
+            logReduce(x, s, ed);
+            double s2 = s*s;
+            double p  = 1.0 + s2*(1.0/3 + s2*(1.0/5 + s2*(1.0/7 + s2*(1.0/9 + s2*(1.0/11)))));
+            return ed*M_LN2 + 2.0*s*p;
+        }
+
+        static double log_1e6(const double &x) {
+            double s, ed;
+            logReduce(x, s, ed);
+            double s2 = s*s;
+            double p  = 1.0 + s2*(1.0/3 + s2*(1.0/5 + s2*(1.0/7)));
+            return ed*M_LN2 + 2.0*s*p;
+        }
+
+        ////////////////////////////////////////////////////////////////////////
+        /*! x^(1/3) from a bit-level guess (error < 3.2%) refined by a Halley
+         *  step (error 2E-5), then another Halley step (1E-14) or a Newton
+         *  step (4E-10, enough for acc_1e6). For normal positive x only.
+         */
+
+        static double cbrt_1e10(const double &x) {
+            double y = cbrtGuess(x);
+            y = y*((y*y*y + 2.0*x)/(2.0*y*y*y + x));
+            y = y*((y*y*y + 2.0*x)/(2.0*y*y*y + x));
+            return y;
+        }
+
+        static double cbrt_1e6(const double &x) {
+            double y = cbrtGuess(x);
+            y = y*((y*y*y + 2.0*x)/(2.0*y*y*y + x));
+            y = (2.0*y + x/(y*y))*(1.0/3);
+            return y;
+        }
+
+    private:
+
+        static double expScale(const double &x_p, const int &low) {
+            const double shift = 6755399441055744.0;            // 1.5*2^52
+            const double ln2hi = 6.93147180369123816490e-01;    // ln2 = ln2hi + ln2lo, ln2hi*k exact
+            const double ln2lo = 1.90821492927058770002e-10;
+            const double xmax  = 709.782712893384;              // log(DBL_MAX): exp(xmax) is finite
+            double x  = x_p < -708.0 ? -708.0 : (x_p > xmax ? xmax : x_p);
+            double kd = x*M_LOG2E + shift;
+            uint64_t kb;
+            memcpy(&kb, &kd, sizeof(kb));
+            kd -= shift;
+            double r  = (x - kd*ln2hi) - kd*ln2lo;
+            double e  = 1.0 + (low ? expm1_1e6(r) : expm1_1e10(r));
+            uint64_t eb;
+            memcpy(&eb, &e, sizeof(eb));
+            eb += kb << 52;
+            memcpy(&e, &eb, sizeof(e));
+            return x_p < -708.0 ? 0.0 : (x_p > xmax ? HUGE_VAL : (x_p != x_p ? x_p : e));
+        }
+
+        static void logReduce(const double &x, double &s, double &ed) {
+            const uint64_t mant = 0x000FFFFFFFFFFFFFULL;
+            const uint64_t one  = 0x3FF0000000000000ULL;
+            uint64_t xb;
+            memcpy(&xb, &x, sizeof(xb));
+            uint64_t eb = (xb >> 52) | 0x4330000000000000ULL; // 2^52 + biased exponent
+            uint64_t mb = (xb & mant) | one;                   // m in [1,2)
+            double m;
+            memcpy(&ed, &eb, sizeof(ed));
+            memcpy(&m,  &mb, sizeof(m));
+            ed -= 4503599627371519.0;                          // 2^52 + 1023
+            bool big = m > M_SQRT2;
+            m   = big ? 0.5*m : m;
+            ed  = big ? ed + 1.0 : ed;
+            s   = (m - 1.0)/(m + 1.0);
+        }
+
+        static double cbrtGuess(const double &x) {
+            uint64_t xb;
+            memcpy(&xb, &x, sizeof(xb));
+            xb = xb/3 + 0x2A9F7893782DA1CEULL;
+            double y;
+            memcpy(&y, &xb, sizeof(y));
+            return y;
+        }
+
+};
@@ -0,0 +1,224 @@
+/**
+ * @file soot_DQMOM.cc
+ * Source file for class soot_DQMOM
+ * @author Victoria B. Lansinger
+ */
+
+#include "soot_DQMOM.h"
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Sets src: sources of the node weights and weighted abscissas. Also sets
+ *  gasSootSources.
+ *  Units: #/(m^3*s) for the weights, kg-soot/(m^3*s) for the weighted abscissas
+ */
+
+void soot_DQMOM::setSrc() {
+
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
+    //---------- nodes from the transported variables (no inversion)
+
+    int n = nsvar/2;
+    double M0 = 0.0;
+    double M1 = 0.0;
+    for (int i=0; i<n; i++) {
+        bool empty = !(sootvar[i] > 0.0 && sootvar[n+i] > 0.0);
+        wts[i]  = empty ? 0.0 : sootvar[i];
+        absc[i] = empty ? 0.0 : sootvar[n+i]/sootvar[i];
+        M0 += wts[i];
+        M1 += wts[i]*absc[i];
+    }
+
+    if (M0 == 0.0) {                                  // no particles
+        setSrc_nucOnly();
+        saveSrcCache();
+        return;
+    }
+
+    //---------- moment sources S_k of the nodes, then node sources
+
+    setNodeSrc(M0, M1);                               // src = S_k, k < nsvar; sets gasSootSources
+
+    if (!solveNodeSrc(M1/M0)) {                       // coincident nodes: keep S_0, S_1 on the largest node
+        nSingular++;
+        int imax = max_element(wts.begin(), wts.end()) - wts.begin();
+        double S0 = src[0];
+        double S1 = src[1];
+        src.assign(nsvar, 0.0);
+        src[imax]   = S0;
+        src[n+imax] = S1;
+    }
+
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! solveNodeSrc function
+ *
+ *      Replaces the moment sources S_k in src by the node sources, solving
+ *          sum_i (1-k)*x_i^k * a_i + k*x_i^(k-1) * b_i = S_k/m_mean^k
+ *      for k < nsvar, with x_i = m_i/m_mean, a_i = dw_i/dt, and
+ *      b_i = d(w_i*m_i)/dt / m_mean. Scaling by the mean mass keeps the
+ *      entries near O(1); the columns are equilibrated and the system is
+ *      solved by Gaussian elimination with partial pivoting. Empty nodes
+ *      get the abscissa (i+1)*m_nuc, so nucleation can fill them. Returns
+ *      false (src unchanged) if the system is singular, i.e., two nodes
+ *      share an abscissa.
+ *
+ *      @param m_mean   /input  mean particle mass M1/M0 (kg)
+ */
+
+bool soot_DQMOM::solveNodeSrc(const double &m_mean) {
+
+    int n  = nsvar/2;
+    int nn = nsvar;
+    double m_nuc = Cmin*MW_c/Na;
+
+    vector<double> &A = Amat;
+    vector<double> b(nn);
+
+    //---------- system in units of the mean mass
+
+    double s = 1.0;
+    for (int k=0; k<nn; k++, s*=m_mean)
+        b[k] = src[k]/s;
+
+    for (int i=0; i<n; i++) {
+        double x   = (wts[i] > 0.0 ? absc[i] : (i+1)*m_nuc)/m_mean;
+        double xk1 = 0.0;                              // x^(k-1)
+        double xk  = 1.0;                              // x^k
+        for (int k=0; k<nn; k++) {
+            A[k*nn+i]   = (1-k)*xk;
+            A[k*nn+n+i] = k*xk1;
+            xk1 = xk;
+            xk *= x;
+        }
+    }
+
+    for (int j=0; j<nn; j++) {                         // column equilibration
+        colScale[j] = 0.0;
+        for (int k=0; k<nn; k++)
+            colScale[j] = max(colScale[j], abs(A[k*nn+j]));
+        if (!(colScale[j] > 0.0) || colScale[j] > 1.0E300)
+            return false;
+        for (int k=0; k<nn; k++)
+            A[k*nn+j] /= colScale[j];
+    }
+
+    //---------- Gaussian elimination, partial pivoting
+
+    for (int c=0; c<nn; c++) {
+        int p = c;
+        for (int r=c+1; r<nn; r++)
+            if (abs(A[r*nn+c]) > abs(A[p*nn+c]))
+                p = r;
+        if (!(abs(A[p*nn+c]) > 1.0E-13))
+            return false;
+        if (p != c) {
+            for (int j=0; j<nn; j++)
+                swap(A[c*nn+j], A[p*nn+j]);
+            swap(b[c], b[p]);
+        }
+        for (int r=c+1; r<nn; r++) {
+            double f = A[r*nn+c]/A[c*nn+c];
+            for (int j=c; j<nn; j++)
+                A[r*nn+j] -= f*A[c*nn+j];
+            b[r] -= f*b[c];
+        }
+    }
+    for (int r=nn-1; r>=0; r--) {
+        for (int j=r+1; j<nn; j++)
+            b[r] -= A[r*nn+j]*b[j];
+        b[r] /= A[r*nn+r];
+    }
+
+    //---------- back to SI
+
+    for (int i=0; i<n; i++) {
+        src[i]   = b[i]/colScale[i];                   // #/m3*s
+        src[n+i] = b[n+i]/colScale[n+i]*m_mean;        // kg/m3*s
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setSrc_nucOnly function
+ *
+ *      DQMOM version of soot::setSrc_nucOnly: new particles (mass m_nuc) go
+ *      to the first node, dw_0/dt = Jnuc and d(w_0*m_0)/dt = m_nuc*Jnuc.
+ *
+ *      Call set_gas_state_vars first.
+ */
+
+void soot_DQMOM::setSrc_nucOnly() {
+
+    double Jnuc  = getNucleationRate();                 // no particles: empty mi, wi
+    double m_nuc = Cmin*MW_c/Na;                        // after nucleation (PAH resets Cmin)
+
+    src.assign(nsvar, 0.0);
+    src[0]       = Jnuc;
+    src[nsvar/2] = Jnuc*m_nuc;
+
+    set_gasSootSources(Jnuc*m_nuc, 0.0, 0.0, 0.0);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getNumberDensity function
+ *
+ *      Total number density: the sum of the node weights.
+ *
+ *      @param M   /input soot variables of the cell
+ */
+
+double soot_DQMOM::getNumberDensity(const vector<double> &M) {
+
+    double N = 0.0;
+    for (int i=0; i<nsvar/2; i++)
+        N += M[i];
+    return N;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getModelCost function
+ *
+ *      Model part of soot::getPredictedCost: the pair kernels scale as
+ *      nsvar^2 and the node source system as nsvar^3 (small for the usual
+ *      2 to 4 nodes); there is no moment inversion. Condensation of the
+ *      PAH dimer scales as the number of nodes.
+ *
+ *      @param M   /input soot variables of the cell
+ */
+
+double soot_DQMOM::getModelCost(const vector<double> &M) {
+
+    double c = 8.0 + 1.6*nsvar*nsvar + 0.1*nsvar*nsvar*nsvar;
+    if (nucleation_mech == "PAH")
+        c += 1.5*nsvar;
+
+    return c;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! addCounters function
+ *
+ *      soot::addCounters plus nSingular.
+ *
+ *      @param s   /inout  model whose counters are moved (a soot_DQMOM)
+ */
+
+void soot_DQMOM::addCounters(soot *s) {
+
+    soot_DQMOM *d = dynamic_cast<soot_DQMOM*>(s);
+    if (d)
+        nSingular += d->nSingular;
+    soot::addCounters(s);
+
+}
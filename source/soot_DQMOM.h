@@ -0,0 +1,103 @@
+/**
+ * @file soot_DQMOM.h
+ * Header file for class soot_DQMOM
+ */
+
+#pragma once
+
+#include "soot_QMOM.h"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing child soot_DQMOM of parent dv object.
+ *
+ *  Direct quadrature method of moments: the n = nsvar/2 nodes are
+ *  transported directly, so no moment inversion is needed in setSrc.
+ *      sootvar[i]   = w_i         weight of node i (#/m3)
+ *      sootvar[n+i] = w_i*m_i     weighted abscissa of node i (kg/m3)
+ *  The moment sources S_k (k < nsvar) come from the same rate laws as
+ *  QMOM (soot_QMOM::setNodeSrc) evaluated at the nodes, and the node
+ *  sources from the linear system
+ *      sum_i (1-k)*m_i^k * dw_i/dt + k*m_i^(k-1) * d(w_i*m_i)/dt = S_k
+ *  solved per cell (in units of the mean mass). Gas sources are the same
+ *  as QMOM's for the same nodes.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class soot_DQMOM : public soot_QMOM {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    private:
+
+        vector<double>        Amat;       ///< node source system, nsvar x nsvar (workspace)
+        vector<double>        colScale;   ///< column scales of Amat (workspace)
+
+    public:
+
+        long int              nSingular;  ///< setSrc calls with a singular node system (see solveNodeSrc)
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        virtual void setSrc();
+        virtual soot *clone() const { return new soot_DQMOM(*this); }
+        virtual void reset_counters() { soot::reset_counters(); nSingular = 0; }
+        virtual void addCounters(soot *s);
+
+    protected:
+
+        virtual void   setSrc_nucOnly();
+        virtual double getNumberDensity(const vector<double> &M);
+        virtual double getModelCost(const vector<double> &M);
+
+    private:
+
+        bool    solveNodeSrc(const double &m_mean);
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        soot_DQMOM(const int      p_nsvar,
+                   vector<string> &spNames,
+                   vector<string> &PAH_spNames,
+                   vector<int>    &p_nC_PAH,
+                   vector<double> &p_MW_sp,
+                   int            p_Cmin,
+                   double         p_rhoSoot,
+                   string         p_nucleation_mech,
+                   string         p_growth_mech,
+                   string         p_oxidation_mech,
+                   string         p_coagulation_mech) :
+            soot(p_nsvar, spNames, PAH_spNames, p_nC_PAH, p_MW_sp, p_Cmin, p_rhoSoot,
+                 p_nucleation_mech, p_growth_mech, p_oxidation_mech, p_coagulation_mech),
+            soot_QMOM(p_nsvar, spNames, PAH_spNames, p_nC_PAH, p_MW_sp, p_Cmin, p_rhoSoot,
+                      p_nucleation_mech, p_growth_mech, p_oxidation_mech, p_coagulation_mech){
+
+            if (nsvar < 2 || nsvar%2 != 0) {
+                cout << endl << "ERROR: soot_DQMOM needs an even nsvar (weights and weighted abscissas)" << endl;
+                exit(0);
+            }
+            Amat.resize(nsvar*nsvar);
+            colScale.resize(nsvar);
+            nSingular = 0;
+        }
+
+        virtual ~soot_DQMOM(){}
+
+};
+
+
+////////////////////////////////////////////////////////////////////////////////
+
+
+
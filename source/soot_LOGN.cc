@@ -5,8 +5,13 @@
  */
 
 #include "soot_LOGN.h"
+#include "tableCache.h"
+#include "sootKernels.h"
+#include <sstream>
+#include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 
 ////////////////////////////////////////////////////////////////////////////////
 /*! Sets src: soot moment source terms. Also sets gasSootSources.
@@ -15,70 +20,75 @@
 
 void soot_LOGN::setSrc() {
 
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
     //domn->domc->enforceSootMom();
 
-    M0 = sootvar[0];                                   // M0 = #/m3
-    M1 = sootvar[0];                                   // M1 = rhoYs = kg/m3
-    M2 = sootvar[0];                                   // M2 = kg2/m3
+    vector<double> Mp;                                 // M0*M2 < M1^2 (sigma_g < 1) is not realizable:
+    realizableMoments(sootvar, Mp);                    // M2 is projected to the monodisperse M1^2/M0
 
-    //--------- nucleation and condensation terms
+    M0 = Mp[0];                                        // M0 = #/m3
+    M1 = Mp[1];                                        // M1 = rhoYs = kg/m3
+    M2 = Mp[2];                                        // M2 = kg2/m3
 
-    double b_coag = 0.8536;                            // use 1/sqrt(2)=0.707 or 1 or an avg=0.8536 (Lignell thesis p. 58)
+    setFracMoments();                                  // all Mk(k) used below
+
+    //--------- nucleation and condensation terms
 
     double N0;                                         // #/m3*s
     double N1;                                         // kg/m3*s
     double N2;                                         // kg2/m3*s
 
     double Cnd0 = 0.0;                                 // by definition.
-    double Cnd1;
-    double Cnd2;
+    double Cnd1 = 0.0;
+    double Cnd2 = 0.0;
 
     double Kfm = get_Kfm();                            // used in coagulation below
     double Kc  = get_Kc();                             // used below
     double Kcp = get_Kcp();                            // used below
 
-    double mmin = Cmin*MW_c/Na;
-    double Jnuc;
+    double Jnuc = 0.0;
     if(nucleation_mech !="PAH")
         Jnuc = getNucleationRate();
-    else {
+    else if (set_m_dimer() > 0.0) {                    // sets m_dimer and Cmin
 
         //------ nucleation
 
-        double wdotD = set_m_dimer();
-
 
         double mD  = m_dimer;
-        double Ifm = Kfm*b_coag*( M0*pow(mD,1./6.) + 2*Mk(1./3.)*pow(mD,-1./6.) +
-                Mk(2./3.)*pow(mD,-1./2.) + Mk(-1./2.)*pow(mD,2./3.) +
-                2*Mk(-1./6.)*pow(mD,1./3.) + Mk(1./6.) );
-        double Ic  = Kc*( 2*M0 + Mk(-1./3.)*pow(mD,1./3.) + Mk(1./3.)*pow(mD,-1./3.) +
-                Kcp*( M0*pow(mD,-1./3.) + Mk(-1./3.) +
-                    Mk(1./3.)*pow(mD,-2./3.) + Mk(-2./3.)*pow(mD,1./3.)) );
+        double Ifm = Kfm*b_coag*( M0*sootMath::pow16(mD) + 2*Mk(1./3.)*sootMath::pow(mD,-1./6.) +
+                Mk(2./3.)*sootMath::pow(mD,-1./2.) + Mk(-1./2.)*sootMath::pow23(mD) +
+                2*Mk(-1./6.)*sootMath::cbrt(mD) + Mk(1./6.) );
+        double Ic  = Kc*( 2*M0 + Mk(-1./3.)*sootMath::cbrt(mD) + Mk(1./3.)*sootMath::pow(mD,-1./3.) +
+                Kcp*( M0*sootMath::pow(mD,-1./3.) + Mk(-1./3.) +
+                    Mk(1./3.)*sootMath::pow(mD,-2./3.) + Mk(-2./3.)*sootMath::cbrt(mD)) );
 
         double I_beta_DS = Ic*Ifm/(Ic+Ifm);            // harmonic mean
 
-        double beta_DD = getCoagulationRate(mD, mD);   // dimer self-collision rate
-        double DIMER = 2.0*wdotD/(I_beta_DS + sqrt(I_beta_DS*I_beta_DS + 4*beta_DD*wdotD));   // #/m3
+        beta_DD = getCoagulationRate(mD, mD);          // dimer self-collision rate
+        solve_Ndimer(I_beta_DS);                       // sets DIMER, #/m3
 
         Jnuc = 0.5*beta_DD*DIMER*DIMER;                // #/m3*s
 
         //------ PAH condensation
 
         double Ifm1 = Ifm;
-        double Ifm2 = Kfm*b_coag*( M1*pow(mD,1./6.) + 2*Mk(4./3.)*pow(mD,-1./6.) +
-                Mk(5./3.)*pow(mD,-1./2.) + Mk( 1./2.)*pow(mD,2./3.) +
-                2*Mk( 5./6.)*pow(mD,1./3.) + Mk(7./6.) );
+        double Ifm2 = Kfm*b_coag*( M1*sootMath::pow16(mD) + 2*Mk(4./3.)*sootMath::pow(mD,-1./6.) +
+                Mk(5./3.)*sootMath::pow(mD,-1./2.) + Mk( 1./2.)*sootMath::pow23(mD) +
+                2*Mk( 5./6.)*sootMath::cbrt(mD) + Mk(7./6.) );
         double Ic1  = Ic;
-        double Ic2  = Kc*( 2*M1 + Mk( 2./3.)*pow(mD,1./3.) + Mk(4./3.)*pow(mD,-1./3.) +
-                Kcp*( M1*pow(mD,-1./3.) + Mk( 2./3.) +
-                    Mk(4./3.)*pow(mD,-2./3.) + Mk( 1./3.)*pow(mD,1./3.)) );
+        double Ic2  = Kc*( 2*M1 + Mk( 2./3.)*sootMath::cbrt(mD) + Mk(4./3.)*sootMath::pow(mD,-1./3.) +
+                Kcp*( M1*sootMath::pow(mD,-1./3.) + Mk( 2./3.) +
+                    Mk(4./3.)*sootMath::pow(mD,-2./3.) + Mk( 1./3.)*sootMath::cbrt(mD)) );
 
         Cnd1 =     mD*DIMER* (Ic1*Ifm1)/(Ic1+Ifm1);    // applying harmonic means
         Cnd2 = 2.0*mD*DIMER* (Ic2*Ifm2)/(Ic2+Ifm2);
     }
     //-----
 
+    double mmin = Cmin*MW_c/Na;                        // after set_m_dimer (PAH resets Cmin)
+
     N0 = Jnuc;                                         // #/m3*s
     N1 = Jnuc*mmin;                                    // kg/m3*s
     N2 = Jnuc*mmin*mmin;                               // kg2/m3*s
@@ -87,7 +97,7 @@ void soot_LOGN::setSrc() {
 
     double Kgrw  = getGrowthRate(M0, M1);              // kg/m2*s
 
-    double term = Kgrw * M_PI*pow(6.0/rhoSoot/M_PI,2.0/3.0);
+    double term = Kgrw * M_PI*sootMath::pow23(6.0/rhoSoot/M_PI);
 
     double G0 = 0.0;                                   // zero by definition, #/m3*s
     double G1 = term * Mk(2./3.);                      // kg/m3*s
@@ -98,56 +108,345 @@ void soot_LOGN::setSrc() {
     double Koxi  = getOxidationRate(M0, M1);           // kg/m2*s
 
     double X0 = 0.0;                                   // zero by definition, #/m3*s
-    double X1 = Koxi * M_PI*pow(6.0/rhoSoot/M_PI,2.0/3.0) * Mk(2./3.);      // kg/m3*s
-    double X2 = Koxi * M_PI*pow(6.0/rhoSoot/M_PI,2.0/3.0) * Mk(5./3.) * 2;  // kg2/m3*s
+    double X1 = Koxi * M_PI*sootMath::pow23(6.0/rhoSoot/M_PI) * Mk(2./3.);      // kg/m3*s
+    double X2 = Koxi * M_PI*sootMath::pow23(6.0/rhoSoot/M_PI) * Mk(5./3.) * 2;  // kg2/m3*s
 
     //--------- coagulation terms
 
+    double C0 = 0.0;
+    double C1 = 0.0;                                   // zero by definition, kg/m3*s
+    double C2 = 0.0;
+    if (!splitCoag)
+        getCoagSrc(Kfm, Kc, Kcp, C0, C2);
+
+    //--------- combinine to make source terms
+
+    src[0] = (N0 + G0 + Cnd0 - X0 + C0);               // #/m3*s
+    src[1] = (N1 + G1 + Cnd1 - X1 + C1);               // kg-soot/m3*s
+    src[2] = (N2 + G2 + Cnd2 - X2 + C2);               // kg-soot^2/m3*s
+
+    //---------- compute gas source terms
+
+    set_gasSootSources(N1, Cnd1, G1, X1);
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getCoagSrc function
+ *    Calculates the M0 and M2 coagulation source terms (M1 is unchanged) as
+ *    the harmonic mean of the free-molecular and continuum forms.
+ *    Uses the tabulated integrals if set_coag_table was called and the
+ *    state is within the table, otherwise the fractional moments.
+ *
+ *    @param Kfm  \input  free-molecular coagulation coefficient
+ *    @param Kc   \input  continuum coagulation coefficient
+ *    @param Kcp  \input  continuum coagulation coefficient (slip)
+ *    @param C0   \output M0 source, #/m3*s
+ *    @param C2   \output M2 source, kg2/m3*s
+ *
+ *    Call setFracMoments first.
+ */
+
+void soot_LOGN::getCoagSrc(const double &Kfm, const double &Kc, const double &Kcp,
+                           double &C0, double &C2) {
+
+    if (useCoagTable && coagFromTable(Kfm, Kc, Kcp, C0, C2))
+        return;
+
     //---- free molecular
     double C0_fm = -Kfm * b_coag * (M0*Mk(1./6.) + 2.0*Mk(1./3.)*Mk(-1./6.) +
             Mk(2./3.)*Mk(-1./2.));                     // #/m3*s
-    double C1_fm = 0.0;                                // zero by definition, kg/m3*s
     double C2_fm = 2*Kfm* b_coag * (M1*Mk(7./6.) + 2*Mk(4./3.)*Mk(5./6.) +
             Mk(5./3.)*Mk(1./2.));                      // kg2/m3*s
 
     //---- continuum
     double C0_c = -Kc*( M0*M0 + Mk(1./3.)*Mk(-1./3.) + Kcp*(M0*Mk(-1./3.) + Mk(1./3.)*Mk(-2./3.)) );
-    double C1_c = 0.0;
     double C2_c = 2*Kc*(M1*M1 + Mk(2./3.)*Mk(4./3.) + Kcp*(M1*Mk(2./3.) + Mk(1./3.)*Mk(4./3.)));
 
     //----- harmonic mean
-    double C0 = C0_fm*C0_c/(C0_fm+C0_c);
-    double C1 = 0.0;
-    double C2 = C2_fm*C2_c/(C2_fm+C2_c);
+    C0 = C0_fm*C0_c/(C0_fm+C0_c);
+    C2 = C2_fm*C2_c/(C2_fm+C2_c);
 
-    //--------- combinine to make source terms
+}
 
-    src[0] = (N0 + G0 + Cnd0 - X0 + C0);               // #/m3*s
-    src[1] = (N1 + G1 + Cnd1 - X1 + C1);               // kg-soot/m3*s
-    src[2] = (N2 + G2 + Cnd2 - X2 + C2);               // kg-soot^2/m3*s
+////////////////////////////////////////////////////////////////////////////////
+/*! Advances sootvar over dt for coagulation only (see soot::advanceCoagulation).
+ *
+ *      Writing the coagulation sources as C0 = -a*M0^2 and C2 = b*M0^2, with
+ *      a and r = (b/a)/(M1/M0)^2 functions of the mean size and width only,
+ *      and M1 constant:
+ *          M0(dt) = M0/(1 + a*M0*dt)
+ *          M2(dt) = M2 + r*M1^2*(1/M0(dt) - 1/M0)     (dM2/dM0 = -b/a)
+ *      This is exact for frozen a, r and bounded for any dt. Scaling b/a with
+ *      the mean mass squared keeps r nearly constant as particles grow.
+ *      For the self-consistent update a and r are re-evaluated at the
+ *      midpoint state of the step (midpoint in 1/M0) and the step is redone.
+ *
+ *      @param dt      /input  time step (s)
+ *      @param nIter   /input  number of midpoint updates of a, r (0 = frozen)
+ */
 
-    //---------- compute gas source terms
+void soot_LOGN::advanceCoagulation(const double &dt, const int &nIter) {
 
-    set_gasSootSources(N1, Cnd1, G1, X1);
+    double M0_0 = sootvar[0];
+    double M2_0 = sootvar[2];
+    M1 = sootvar[1];
+
+    if (M0_0 <= 0.0 || M1 <= 0.0 || M2_0 <= 0.0)
+        return;
+
+    double a, b;
+    double M0_1 = M0_0;
+    double M2_1 = M2_0;
+
+    for (int it=0; it<=nIter; it++) {
+
+        double M0_m = 2.0/(1.0/M0_0 + 1.0/M0_1);
+        getCoagCoefs(M0_m, 0.5*(M2_0+M2_1), a, b);
+
+        if (a <= 0.0)
+            break;
+
+        double r = b/a*(M0_m*M0_m)/(M1*M1);
+        M0_1 = M0_0/(1.0 + a*M0_0*dt);
+        M2_1 = M2_0 + r*M1*M1*(1.0/M0_1 - 1.0/M0_0);
+    }
+
+    sootvar[0] = M0_1;
+    sootvar[2] = M2_1;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getCoagCoefs function
+ *    Coagulation coefficients a = -C0/M0^2 and b = C2/M0^2 at (m0, M1, m2).
+ *    Sets M0 and M2 and the fractional moments for that state.
+ *
+ *    @param m0   \input  moment 0
+ *    @param m2   \input  moment 2
+ *    @param a    \output -C0/M0^2
+ *    @param b    \output  C2/M0^2
+ */
+
+void soot_LOGN::getCoagCoefs(const double &m0, const double &m2, double &a, double &b) {
+
+    M0 = m0;
+    M2 = m2;
+    setFracMoments();
+
+    double C0, C2;
+    getCoagSrc(get_Kfm(), get_Kc(), get_Kcp(), C0, C2);
+
+    a = -C0/(M0*M0);
+    b =  C2/(M0*M0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! coagFromTable function
+ *    Coagulation source terms from the tabulated lognormal integrals.
+ *    With s^2 = ln(sigma_g)^2 = ln(M0*M2/M1^2), mg the geometric mean mass,
+ *    and Kn = Kcp*mg^(-1/3):
+ *        C0_fm = -Kfm*b*M0^2*mg^(1/6)  * F0(s)
+ *        C2_fm = 2*Kfm*b*M0^2*mg^(13/6)* F2(s)
+ *        C0_c  = -Kc*M0^2      *(A0(s) + Kn*B0(s))
+ *        C2_c  = 2*Kc*M0^2*mg^2*(A2(s) + Kn*B2(s))
+ *    The Kn dependence is exactly linear, so only s is tabulated.
+ *    Returns false (C0, C2 not set) if the state is outside the table.
+ *
+ *    @param Kfm  \input  free-molecular coagulation coefficient
+ *    @param Kc   \input  continuum coagulation coefficient
+ *    @param Kcp  \input  continuum coagulation coefficient (slip)
+ *    @param C0   \output M0 source, #/m3*s
+ *    @param C2   \output M2 source, kg2/m3*s
+ */
+
+bool soot_LOGN::coagFromTable(const double &Kfm, const double &Kc, const double &Kcp,
+                              double &C0, double &C2) {
+
+    if (M0 <= 0.0 || M1 <= 0.0 || M2 <= 0.0)
+        return false;
+
+    double s2 = sootMath::log(M0*M2/(M1*M1));
+    if (s2 < 0.0)                                      // not a lognormal
+        return false;
+
+    double x = sqrt(s2)/dsCoag;
+    int    i = (int)x;
+    if (i >= nCoagTable-1)
+        return false;
+    double f = x - i;
+
+    double I[6];                                       // F0, F2, A0, B0, A2, B2
+    for (int j=0; j<6; j++)
+        I[j] = (1.0-f)*coagData[6*i+j] + f*coagData[6*(i+1)+j];
+
+    double mg   = M1/M0*sootMath::exp(-0.5*s2);        // geometric mean mass
+    double mg16 = sootMath::pow16(mg);
+    double Kn   = Kcp/(mg16*mg16);                     // Kcp*mg^(-1/3)
+    double M00  = M0*M0;
+
+    double C0_fm = -Kfm*b_coag*M00*mg16*I[0];
+    double C2_fm = 2*Kfm*b_coag*M00*mg*mg*mg16*I[1];
+    double C0_c  = -Kc*M00*(I[2] + Kn*I[3]);
+    double C2_c  = 2*Kc*M00*mg*mg*(I[4] + Kn*I[5]);
+
+    C0 = C0_fm*C0_c/(C0_fm+C0_c);
+    C2 = C2_fm*C2_c/(C2_fm+C2_c);
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! clone function
+ *    Returns a copy of this object (see soot::clone); the copy's table
+ *    pointer is moved to its own table (mapped cache data is shared).
+ */
+
+soot *soot_LOGN::clone() const {
+
+    soot_LOGN *c = new soot_LOGN(*this);
+    if (!coagTable.empty())
+        c->coagData = &c->coagTable[0];
+    return c;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! set_coag_table function
+ *    Turns tabulated coagulation on or off and builds the table of the
+ *    dimensionless lognormal collision integrals F0, F2, A0, B0, A2, B2
+ *    (see coagFromTable) on a uniform grid in s = ln(sigma_g).
+ *    Each integral is a sum of terms exp(c*s^2/2) with c from the exponents
+ *    of the paired fractional moments. States with sigma_g > p_sigmax fall
+ *    back to the fractional-moment evaluation.
+ *
+ *    @param p_useTable   \input  turn tabulation on or off
+ *    @param p_sigmax     \input  largest geometric standard deviation tabulated (> 1)
+ *    @param p_n          \input  number of grid points (>= 2)
+ *
+ *    The table is taken from the tableCache if present (see
+ *    soot::set_table_cache), else built and saved there.
+ *
+ *    Returns the largest relative interpolation error of the table (checked
+ *    at interval midpoints, where linear interpolation error is largest).
+ */
+
+double soot_LOGN::set_coag_table(const bool &p_useTable, const double &p_sigmax, const int &p_n) {
+
+    useCoagTable = p_useTable;
+    if (!useCoagTable)
+        return 0.0;
+
+    if (p_n < 2 || !(p_sigmax > 1.0)) {
+        cout << endl << "ERROR: set_coag_table needs p_n >= 2 and p_sigmax > 1" << endl;
+        exit(0);
+    }
+
+    nCoagTable = p_n;
+    dsCoag     = log(p_sigmax)/(nCoagTable-1);
+
+    //---------- from the table cache (data: coagTableErr, then the table)
+
+    ostringstream key;
+    key.precision(17);
+    key << "lognCoagIntegrals.v" << coagTableVersion << ";sigmax=" << p_sigmax << ";n=" << p_n;
+    long int nData;
+    const double *d = tableCache::load("lognCoagTable", key.str(), nData);
+    if (d && nData == 1+6*nCoagTable) {
+        coagTableErr = d[0];
+        coagTable.clear();
+        coagData = d+1;
+        return coagTableErr;
+    }
+
+    //---------- build
+
+    coagTable.resize(6*nCoagTable);
+    coagData = &coagTable[0];
+
+    for (int i=0; i<nCoagTable; i++)
+        lognCoagIntegrals(i*dsCoag, &coagTable[6*i]);
+
+    coagTableErr = 0.0;
+    double I[6];
+    for (int i=0; i<nCoagTable-1; i++) {
+        lognCoagIntegrals((i+0.5)*dsCoag, I);
+        for (int j=0; j<6; j++) {
+            double Ii = 0.5*(coagTable[6*i+j] + coagTable[6*(i+1)+j]);
+            coagTableErr = max(coagTableErr, abs(Ii-I[j])/I[j]);
+        }
+    }
+
+    vector<double> data(1, coagTableErr);
+    data.insert(data.end(), coagTable.begin(), coagTable.end());
+    tableCache::save("lognCoagTable", key.str(), data);
+
+    return coagTableErr;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! lognCoagIntegrals function
+ *    Evaluates the dimensionless lognormal coagulation integrals at s.
+ *    A product Mk(a)*Mk(b) of a lognormal is M0^2*mg^(a+b)*exp((a^2+b^2)*s^2/2).
+ *
+ *    @param s    \input  ln(sigma_g)
+ *    @param I    \output F0, F2, A0, B0, A2, B2
+ */
+
+void soot_LOGN::lognCoagIntegrals(const double &s, double *I) {
+
+    double h = 0.5*s*s;
+    double c = 1./36.;                                 // (1/6)^2 units
+
+    I[0] =   exp(h*c*1)  + 2*exp(h*c*(4+1))   + exp(h*c*(16+9));       // F0: (0,1/6), (1/3,-1/6), (2/3,-1/2)
+    I[1] =   exp(h*c*(36+49)) + 2*exp(h*c*(64+25)) + exp(h*c*(100+9)); // F2: (1,7/6), (4/3,5/6), (5/3,1/2)
+    I[2] = 1+exp(h*c*(4+4));                                           // A0: (0,0), (1/3,-1/3)
+    I[3] =   exp(h*c*4)  +   exp(h*c*(4+16));                          // B0: (0,-1/3), (1/3,-2/3)
+    I[4] =   exp(h*c*36*2) + exp(h*c*(16+64));                         // A2: (1,1), (2/3,4/3)
+    I[5] =   exp(h*c*(36+16)) + exp(h*c*(4+64));                       // B2: (1,2/3), (1/3,4/3)
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 /*! Mk function
- *    Calculates fractional moments
+ *    Returns a fractional moment from the table filled by setFracMoments.
  *
- *    @param k   \input  fractional moment to compute, corresponds to exponent
+ *    @param k   \input  fractional moment to compute, corresponds to exponent;
+ *                       must be a multiple of 1/6 in [-2/3, 5/3]
  *
  */
 
 double soot_LOGN::Mk(const double &k) {
 
-    double M0_exp = 1 + 0.5*k*(k-3);
-    double M1_exp = k*(2-k);
-    double M2_exp = 0.5*k*(k-1);
+    return Mfrac[(int)floor(6.0*k + 0.5) + 4];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setFracMoments function
+ *    Calculates all fractional moments needed in setSrc:
+ *    Mk = M0^(1+k(k-3)/2) * M1^(k(2-k)) * M2^(k(k-1)/2) for k = -4/6...10/6.
+ *    The logs of M0, M1, M2 are taken once and the table is filled with a
+ *    single (vectorizable) exp loop. Nonpositive moments fall back to pow.
+ *
+ */
+
+void soot_LOGN::setFracMoments() {
 
-    if (M2 == 0.0 && M2_exp < 0)
-        M2_exp = 0;
+    if (M0 > 0.0 && M1 > 0.0 && M2 > 0.0) {
 
-    return pow(M0, M0_exp) * pow(M1, M1_exp) * pow(M2, M2_exp);
-}
+        double lM0 = sootMath::log(M0);
+        double lM1 = sootMath::log(M1);
+        double lM2 = sootMath::log(M2);
 
+        for (int i=0; i<nfrac; i++)
+            Mfrac[i] = fracExps[3*i]*lM0 + fracExps[3*i+1]*lM1 + fracExps[3*i+2]*lM2;
+        sootKernels::exps(Mfrac.size(), &Mfrac[0], &Mfrac[0]);
+        return;
+    }
+
+    for (int i=0; i<nfrac; i++) {
+        double M2_exp = fracExps[3*i+2];
+        if (M2 == 0.0 && M2_exp < 0)
+            M2_exp = 0;
+        Mfrac[i] = sootMath::pow(M0, fracExps[3*i]) * sootMath::pow(M1, fracExps[3*i+1]) * sootMath::pow(M2, M2_exp);
+    }
+}
@@ -27,15 +27,41 @@ class soot_LOGN : virtual public soot {
         double M1;
         double M2;
 
+        static const int nfrac = 15;              ///< fractional moments k = -4/6, -3/6, ..., 10/6
+        vector<double>   fracExps;                ///< exponents of M0, M1, M2 for each k (size 3*nfrac)
+        vector<double>   Mfrac;                   ///< fractional moments for this call (size nfrac)
+
+        static constexpr double b_coag = 0.8536;  ///< use 1/sqrt(2)=0.707 or 1 or an avg=0.8536 (Lignell thesis p. 58)
+
+        bool             useCoagTable;            ///< flag to use tabulated coagulation integrals
+        int              nCoagTable;              ///< number of table points in s = ln(sigma_g)
+        double           dsCoag;                  ///< table spacing in s
+        vector<double>   coagTable;               ///< F0, F2, A0, B0, A2, B2 at each s (size 6*nCoagTable), if built here
+        const double    *coagData;                ///< table values: &coagTable[0] or mapped cache data
+        double           coagTableErr;            ///< max relative interpolation error of the table
+        static const int coagTableVersion = 1;    ///< in the table key: bump when lognCoagIntegrals changes
+
     //////////////////// MEMBER FUNCTIONS /////////////////
 
     public:
 
         virtual void setSrc();
+        virtual soot *clone() const;
+        virtual void advanceCoagulation(const double &dt, const int &nIter=2);
+        double       set_coag_table(const bool &p_useTable, const double &p_sigmax=4.0, const int &p_n=201);
+
+    protected:
+
+        virtual double getModelCost(const vector<double> &M) { return nucleation_mech == "PAH" ? 14.0 : 6.0; }
 
     private:
 
         double Mk(const double &k);
+        void   setFracMoments();
+        void   getCoagSrc(const double &Kfm, const double &Kc, const double &Kcp, double &C0, double &C2);
+        void   getCoagCoefs(const double &m0, const double &m2, double &a, double &b);
+        bool   coagFromTable(const double &Kfm, const double &Kc, const double &Kcp, double &C0, double &C2);
+        void   lognCoagIntegrals(const double &s, double *I);
 
     //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
 
@@ -53,7 +79,21 @@ class soot_LOGN : virtual public soot {
                   string         p_oxidation_mech,
                   string         p_coagulation_mech) :
             soot(p_nsvar, spNames, PAH_spNames, p_nC_PAH, p_MW_sp, p_Cmin, p_rhoSoot,
-                 p_nucleation_mech, p_growth_mech, p_oxidation_mech, p_coagulation_mech){}
+                 p_nucleation_mech, p_growth_mech, p_oxidation_mech, p_coagulation_mech){
+
+            useCoagTable = false;
+            coagTableErr = 0.0;
+            coagData     = 0;
+
+            fracExps.resize(3*nfrac);
+            Mfrac.resize(nfrac);
+            for(int i=0; i<nfrac; i++) {
+                double k = (i-4)/6.0;
+                fracExps[3*i+0] = 1 + 0.5*k*(k-3);
+                fracExps[3*i+1] = k*(2-k);
+                fracExps[3*i+2] = 0.5*k*(k-1);
+            }
+        }
 
         virtual ~soot_LOGN(){}
 
@@ -5,8 +5,10 @@
  */
 
 #include "soot_MOMIC.h"
+#include "sootKernels.h"
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 #include <boost/math/special_functions/binomial.hpp>
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -16,6 +18,9 @@
 
 void soot_MOMIC::setSrc() {
 
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
     //domn->domc->enforceSootMom();                   // make sure moments are positive or zero
 
     vector<double> M = sootvar;                       // M is a reference elsewhere, but not here (due to downselect func)
@@ -25,6 +30,9 @@ void soot_MOMIC::setSrc() {
     int N = nsvar;                                 // local number of moments
     downselectIfNeeded(N);                         // downselect() will not change anything if all moment values >0
 
+    if (N > 0 && (coagulation_mech != "NONE" || nucleation_mech == "PAH"))
+        setFracMoments();                          // for getCoag, all at once
+
     //---------- get chemical soot rates
 
     double Jnuc = getNucleationRate();             // #/m3*s
@@ -56,7 +64,7 @@ void soot_MOMIC::setSrc() {
 
     vector<double> Mgrw(nsvar,0.0);                         // growth source terms for moments
 
-    double Acoef = M_PI*pow(abs(6.0/M_PI/rhoSoot),2.0/3.0); // Acoef = kmol^2/3 / kg^2/3
+    double Acoef = M_PI*sootMath::pow23(abs(6.0/M_PI/rhoSoot)); // Acoef = kmol^2/3 / kg^2/3
     for (int k=1; k<N; k++)                                 // Mgrw[0] = 0.0 by definition
         Mgrw[k] = Kgrw * Acoef * k * MOMIC(k-1.0/3.0,M);    // kg^k/m3*s
 
@@ -91,6 +99,33 @@ void soot_MOMIC::setSrc() {
     //---------- compute gas source terms
 
     set_gasSootSources(Mnuc[1], Mcnd[1], Mgrw[1], Moxi[1]);
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! getModelCost function
+ *
+ *      Model part of soot::getPredictedCost. The cost is dominated by the
+ *      Lagrange interpolations of the fractional moment grid
+ *      (setFracMoments), ~N^2 per grid point, and the coagulation sums, for
+ *      the N moments left by downselectIfNeeded (leading realizable
+ *      moments, at least 2; estimated here by the leading positive ones).
+ *
+ *      @param M   /input soot variables of the cell
+ */
+
+double soot_MOMIC::getModelCost(const vector<double> &M) {
+
+    if (M[0] <= 0.0)
+        return 1.0;
+
+    int N = 0;
+    while (N < nsvar && M[N] > 0.0)
+        N++;
+    N = max(N, 2);
+
+    return (nucleation_mech == "PAH" ? 25.0 : 20.0) + 4.0*N*N;
 
 }
 
@@ -129,7 +164,10 @@ double soot_MOMIC::lagrangeInterp(double x_i, vector<double> x, vector<double> y
  *
  *      Calculates the desired fractional moment by lagrange interpolation
  *      between whole order moments. Because it uses log moments, it will crash
- *      if any moment is less than or equal to zero.
+ *      if any moment is less than or equal to zero. The reduced moments
+ *      need no reference units: log10(M_i/M_0) in units of m_ref^i only
+ *      subtracts i*log10(m_ref), a linear term the interpolation reproduces
+ *      exactly.
  *
  *      @param p     \input     desired interpolation value
  *      @param M     \input     vector of whole order moments
@@ -151,13 +189,56 @@ double soot_MOMIC::MOMIC(double p, vector<double> M) {
     vector<double> x(size,0.0);
 
     for (int i = 0; i < size; i++) {
-        log_mu[i] = log10(M[i] / M[0]);     // reduced moments
+        log_mu[i] = sootMath::log10(M[i] / M[0]);
         x[i] = i;
     }
 
     double log_mu_p = lagrangeInterp(p,x,log_mu);
 
-    return pow(10.0, log_mu_p) * M[0];
+    return sootMath::pow(10.0, log_mu_p) * M[0];
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setFracMoments function
+ *
+ *      Sets Mgrid: MOMIC(p, sootvar) for every p = j/6 - 1/2 that getCoag
+ *      and f_grid use (from -1/2 to N-1+19/6 for the N moments left by
+ *      downselectIfNeeded), instead of interpolating each of them on every
+ *      use (several hundred calls per setSrc). The interpolated log10
+ *      values are converted by one sootKernels::exps call (vectorized at
+ *      the fast sootMath levels); M_0 is kept exact.
+ *
+ *      Call downselectIfNeeded first.
+ */
+
+void soot_MOMIC::setFracMoments() {
+
+    vector<double> &M = sootvar;
+    int size = M.size();
+
+    vector<double> x(size);
+    vector<double> log_mu(size);
+    for (int i = 0; i < size; i++) {
+        log_mu[i] = sootMath::log10(M[i] / M[0]);
+        x[i] = i;
+    }
+    int size_neg = size == 2 ? 2 : 3;                     // as MOMIC: p < 0 uses the first 3 moments
+    vector<double> x_neg(x.begin(), x.begin()+size_neg);
+    vector<double> log_mu_neg(log_mu.begin(), log_mu.begin()+size_neg);
+
+    int nGrid = 6*size + 17;
+    Mgrid.resize(nGrid);
+    for (int j = 0; j < nGrid; j++) {
+        double p = (j-3)/6.0;
+        Mgrid[j] = M_LN10 * (p < 0 ? lagrangeInterp(p, x_neg, log_mu_neg) : lagrangeInterp(p, x, log_mu));
+    }
+
+    sootKernels::exps(nGrid, &Mgrid[0], &Mgrid[0]);       // 10^log_mu_p
+
+    for (int j = 0; j < nGrid; j++)
+        Mgrid[j] *= M[0];
+    Mgrid[3] = M[0];                                      // p = 0
 
 }
 
@@ -165,20 +246,20 @@ double soot_MOMIC::MOMIC(double p, vector<double> M) {
 /*! f_grid function
  *
  *      Calculates the grid function described in Frenklach 2002 MOMIC paper
- *      using lagrange interpolation between whole order moments
+ *      using lagrange interpolation between whole order moments (of
+ *      sootvar; fractional moments from Mgrid, see setFracMoments)
  *
  *      @param x     \input x grid point
  *      @param y     \input y grid point
- *      @param M     \input vector of whole order moments
  *
  */
 
-double soot_MOMIC::f_grid(int x, int y, vector<double> M) {
+double soot_MOMIC::f_grid(int x, int y) {
 
-    double f1_0 = MOMIC(x-1.0/2.0,M)*MOMIC(y+1.0/6.0,M) + 2.0*MOMIC(x-1.0/6.0,M)*MOMIC(y-1.0/6.0,M) + MOMIC(x+1.0/6.0,M)*MOMIC(y-1.0/2.0,M);
+    double f1_0 = Mfrac(x-1.0/2.0)*Mfrac(y+1.0/6.0) + 2.0*Mfrac(x-1.0/6.0)*Mfrac(y-1.0/6.0) + Mfrac(x+1.0/6.0)*Mfrac(y-1.0/2.0);
 
-    double f1_1 = MOMIC(x-1.0/2.0,M)*MOMIC(y+7.0/6.0,M) + 2.0*MOMIC(x-1.0/6.0,M)*MOMIC(y+5.0/6.0,M) + MOMIC(x+1.0/6.0,M)*MOMIC(y+1.0/2.0,M) +
-                  MOMIC(x+1.0/2.0,M)*MOMIC(y+1.0/6.0,M) + 2.0*MOMIC(x+5.0/6.0,M)*MOMIC(y-1.0/6.0,M) + MOMIC(x+7.0/6.0,M)*MOMIC(y-1.0/2.0,M);
+    double f1_1 = Mfrac(x-1.0/2.0)*Mfrac(y+7.0/6.0) + 2.0*Mfrac(x-1.0/6.0)*Mfrac(y+5.0/6.0) + Mfrac(x+1.0/6.0)*Mfrac(y+1.0/2.0) +
+                  Mfrac(x+1.0/2.0)*Mfrac(y+1.0/6.0) + 2.0*Mfrac(x+5.0/6.0)*Mfrac(y-1.0/6.0) + Mfrac(x+7.0/6.0)*Mfrac(y-1.0/2.0);
 
     if (y >= 4) {
 
@@ -187,17 +268,17 @@ double soot_MOMIC::f_grid(int x, int y, vector<double> M) {
         temp_x[1] = 1.0;
 
         vector<double> temp_y(2,0.0);
-        temp_y[0] = log10(f1_0);
-        temp_y[1] = log10(f1_1);
+        temp_y[0] = sootMath::log10(f1_0);
+        temp_y[1] = sootMath::log10(f1_1);
 
         double value = lagrangeInterp(1.0/2.0, temp_x, temp_y);
 
-        return pow(10.0, value);
+        return sootMath::pow(10.0, value);
     }
 
-    double f1_2 =     MOMIC(x-1.0/2.0,M)*MOMIC(y+13.0/6.0,M) + 2.0*MOMIC(x-1.0 /6.0,M)*MOMIC(y+11.0/6.0,M) +     MOMIC(x+1.0 /6.0,M)*MOMIC(y+3.0/2.0,M) +
-                  2.0*MOMIC(x+1.0/2.0,M)*MOMIC(y+7.0 /6.0,M) + 4.0*MOMIC(x+5.0 /6.0,M)*MOMIC(y+5.0 /6.0,M) + 2.0*MOMIC(x+7.0 /6.0,M)*MOMIC(y+1.0/2.0,M) +
-                      MOMIC(x+3.0/2.0,M)*MOMIC(y+1.0 /6.0,M) + 2.0*MOMIC(x+11.0/6.0,M)*MOMIC(y-1.0 /6.0,M) +     MOMIC(x+13.0/6.0,M)*MOMIC(y-1.0/2.0,M);
+    double f1_2 =     Mfrac(x-1.0/2.0)*Mfrac(y+13.0/6.0) + 2.0*Mfrac(x-1.0 /6.0)*Mfrac(y+11.0/6.0) +     Mfrac(x+1.0 /6.0)*Mfrac(y+3.0/2.0) +
+                  2.0*Mfrac(x+1.0/2.0)*Mfrac(y+7.0 /6.0) + 4.0*Mfrac(x+5.0 /6.0)*Mfrac(y+5.0 /6.0) + 2.0*Mfrac(x+7.0 /6.0)*Mfrac(y+1.0/2.0) +
+                      Mfrac(x+3.0/2.0)*Mfrac(y+1.0 /6.0) + 2.0*Mfrac(x+11.0/6.0)*Mfrac(y-1.0 /6.0) +     Mfrac(x+13.0/6.0)*Mfrac(y-1.0/2.0);
 
     if (y >= 3) {
 
@@ -207,19 +288,19 @@ double soot_MOMIC::f_grid(int x, int y, vector<double> M) {
         temp_x[2] = 2.0;
 
         vector<double> temp_y(3,0.0);
-        temp_y[0] = log10(f1_0);
-        temp_y[1] = log10(f1_1);
-        temp_y[2] = log10(f1_2);
+        temp_y[0] = sootMath::log10(f1_0);
+        temp_y[1] = sootMath::log10(f1_1);
+        temp_y[2] = sootMath::log10(f1_2);
 
         double value = lagrangeInterp(1.0/2.0, temp_x, temp_y);
 
-        return pow(10.0, value);
+        return sootMath::pow(10.0, value);
     }
 
-    double f1_3 =     MOMIC(x-1.0/2.0,M)*MOMIC(y+19.0/6.0,M) + 2.0*MOMIC(x-1.0 /6.0,M)*MOMIC(y+17.0/6.0,M) +     MOMIC(x+1.0 /6.0,M)*MOMIC(y+5.0/2.0,M) +
-                  3.0*MOMIC(x+1.0/2.0,M)*MOMIC(y+13.0/6.0,M) + 6.0*MOMIC(x+5.0 /6.0,M)*MOMIC(y+11.0/6.0,M) + 3.0*MOMIC(x+7.0 /6.0,M)*MOMIC(y+3.0/2.0,M) +
-                  3.0*MOMIC(x+3.0/2.0,M)*MOMIC(y+7.0 /6.0,M) + 6.0*MOMIC(x+11.0/6.0,M)*MOMIC(y+5.0 /6.0,M) + 3.0*MOMIC(x+13.0/6.0,M)*MOMIC(y+1.0/2.0,M) +
-                      MOMIC(x+5.0/2.0,M)*MOMIC(y+1.0 /6.0,M) + 2.0*MOMIC(x+17.0/6.0,M)*MOMIC(y-1.0 /6.0,M) +     MOMIC(x+19.0/6.0,M)*MOMIC(y-1.0/2.0,M);
+    double f1_3 =     Mfrac(x-1.0/2.0)*Mfrac(y+19.0/6.0) + 2.0*Mfrac(x-1.0 /6.0)*Mfrac(y+17.0/6.0) +     Mfrac(x+1.0 /6.0)*Mfrac(y+5.0/2.0) +
+                  3.0*Mfrac(x+1.0/2.0)*Mfrac(y+13.0/6.0) + 6.0*Mfrac(x+5.0 /6.0)*Mfrac(y+11.0/6.0) + 3.0*Mfrac(x+7.0 /6.0)*Mfrac(y+3.0/2.0) +
+                  3.0*Mfrac(x+3.0/2.0)*Mfrac(y+7.0 /6.0) + 6.0*Mfrac(x+11.0/6.0)*Mfrac(y+5.0 /6.0) + 3.0*Mfrac(x+13.0/6.0)*Mfrac(y+1.0/2.0) +
+                      Mfrac(x+5.0/2.0)*Mfrac(y+1.0 /6.0) + 2.0*Mfrac(x+17.0/6.0)*Mfrac(y-1.0 /6.0) +     Mfrac(x+19.0/6.0)*Mfrac(y-1.0/2.0);
 
     vector<double> temp_x(4,0.0);
     temp_x[0] = 0.0;
@@ -228,14 +309,14 @@ double soot_MOMIC::f_grid(int x, int y, vector<double> M) {
     temp_x[3] = 3.0;
 
     vector<double> temp_y(4,0.0);
-    temp_y[0] = log10(f1_0);
-    temp_y[1] = log10(f1_1);
-    temp_y[2] = log10(f1_2);
-    temp_y[3] = log10(f1_3);
+    temp_y[0] = sootMath::log10(f1_0);
+    temp_y[1] = sootMath::log10(f1_1);
+    temp_y[2] = sootMath::log10(f1_2);
+    temp_y[3] = sootMath::log10(f1_3);
 
     double value = lagrangeInterp(1.0/2.0, temp_x, temp_y);
 
-    return pow(10.0, value);
+    return sootMath::pow(10.0, value);
 
 }
 
@@ -245,6 +326,7 @@ double soot_MOMIC::f_grid(int x, int y, vector<double> M) {
  *      Calculates coagulation rate for MOMIC based on a weighted average of
  *      continuum and free-molecular values. See Frenklach's 2002 MOMIC paper.
  *      Adapted from python code by Alex Josephson.
+ *      Call setFracMoments first.
  *
  *      @param r    \input  number of the moment to be calculated
  *
@@ -261,8 +343,8 @@ double soot_MOMIC::getCoag(int r) {
     // Calculate Knudsen number to determine regime
 
     double mu_1     = M[1]/M[0];                                // average particle mass (kg)
-    double d_g      = pow(6.0*kb*T/P/M_PI, 1.0/3.0);            // average gas molecular diameter (m)
-    double d_p      = pow(6.0*mu_1/rhoSoot/M_PI, 1.0/3.0);      // average particle diameter (m)
+    double d_g      = sootMath::cbrt(6.0*kb*T/P/M_PI);          // average gas molecular diameter (m)
+    double d_p      = sootMath::cbrt(6.0*mu_1/rhoSoot/M_PI);    // average particle diameter (m)
     double lambda_g = kb*T/(pow(2.0,0.5)*M_PI*pow(d_g,2.0)*P);  // gas mean free path (m)
     double Kn       = lambda_g/d_p;                             // Knudsen number
 
@@ -271,11 +353,11 @@ double soot_MOMIC::getCoag(int r) {
     double Rate_C = 0.0;
 
     double K_C = 2.0*kb*T/(3.0*mu);
-    double K_Cprime = 1.257*lambda_g*pow(M_PI*rhoSoot/6.0,1.0/3.0);
+    double K_Cprime = 1.257*lambda_g*sootMath::cbrt(M_PI*rhoSoot/6.0);
 
     if (r == 0) {
-        Rate_C = -K_C*(pow(M[0],2.0) + MOMIC(1.0/3.0,M)*MOMIC(-1.0/3.0,M) +
-                  K_Cprime*(3.0*MOMIC(-1.0/3.0,M)*M[0] + MOMIC(2.0/3.0,M)*MOMIC(1.0/3.0,M)));
+        Rate_C = -K_C*(pow(M[0],2.0) + Mfrac(1.0/3.0)*Mfrac(-1.0/3.0) +
+                  K_Cprime*(3.0*Mfrac(-1.0/3.0)*M[0] + Mfrac(2.0/3.0)*Mfrac(1.0/3.0)));
     }
     else {
         Rate_C = 0.0;
@@ -285,8 +367,8 @@ double soot_MOMIC::getCoag(int r) {
             }
             else {
                 Rate_C = Rate_C + boost::math::binomial_coefficient<double>(r,k)*
-                         (2.0*M[k]*M[r-k] + MOMIC(k+1.0/3.0,M)*MOMIC(r-k-1.0/3.0,M) + MOMIC(k-1.0/3.0,M)*MOMIC(r-k+1.0/3.0,M) +
-                          2.0*K_Cprime* (2.0*MOMIC(k-1.0/3.0,M)*M[r-k] + M[k]*MOMIC(r-k-1.0/3.0,M) + MOMIC(k-2.0/3.0,M)*MOMIC(r-k+1.0/3.0,M)));
+                         (2.0*M[k]*M[r-k] + Mfrac(k+1.0/3.0)*Mfrac(r-k-1.0/3.0) + Mfrac(k-1.0/3.0)*Mfrac(r-k+1.0/3.0) +
+                          2.0*K_Cprime* (2.0*Mfrac(k-1.0/3.0)*M[r-k] + M[k]*Mfrac(r-k-1.0/3.0) + Mfrac(k-2.0/3.0)*Mfrac(r-k+1.0/3.0)));
             }
         }
         Rate_C = 0.5*K_C*Rate_C;
@@ -296,10 +378,10 @@ double soot_MOMIC::getCoag(int r) {
 
     double Rate_F = 0.0;
 
-    double K_f = 2.2*pow(3.0/(4.0*M_PI*rhoSoot),2.0/3.0) * pow(8.0*M_PI*kb*T,1.0/2.0);
+    double K_f = 2.2*sootMath::pow23(3.0/(4.0*M_PI*rhoSoot)) * sootMath::pow(8.0*M_PI*kb*T,1.0/2.0);
 
     if (r == 0) {
-        Rate_F = -0.5*K_f*f_grid(0,0,M);
+        Rate_F = -0.5*K_f*f_grid(0,0);
     }
     else {
         Rate_F = 0.0;
@@ -308,7 +390,7 @@ double soot_MOMIC::getCoag(int r) {
                 Rate_F = Rate_F;
             }
             else {
-                Rate_F = Rate_F + boost::math::binomial_coefficient<double>(r,k)*f_grid(k,r-k,M);
+                Rate_F = Rate_F + boost::math::binomial_coefficient<double>(r,k)*f_grid(k,r-k);
             }
         }
         Rate_F = 0.5*K_f*Rate_F;
@@ -321,15 +403,18 @@ double soot_MOMIC::getCoag(int r) {
 ////////////////////////////////////////////////////////////////////////////////
 /*! downselectIfNeeded function
  *
- *      Checks the moment set can be used with MOMIC. Downselects if needed.
- *      Zero and negative moment values will trip the flag for downselection.
- *      The floor value is N = 2.
+ *      Checks the moment set can be used with MOMIC. Downselects if needed
+ *      to the leading realizable moments (realizableMoments; this excludes
+ *      zero and negative values), in one step. The floor value is N = 2.
  *
  *      For the case where M0 <= 0, we set N = 0, which means that the source
  *      terms will be initalized but not calculated such that the rates are all
  *      zero. If M1 <= 0, we assign it a value based on M0 and a lognormal
  *      distribution that matches the initialized profile in the domc. This
  *      is a workaround since the lagrange interpolation can't handle M1 = 0.
+ *      M1 is M0 times the profile's mean mass, so M1/M0 is the same in any
+ *      units. (It used to be the mean mass itself, i.e. M0 taken as 1, so
+ *      M1/M0 was off by the factor M0.)
  *
  *      @param &N   \inout number of downselected moments
  *
@@ -349,36 +434,17 @@ void soot_MOMIC::downselectIfNeeded(int &N) {
     // CHECK: M1 <= 0.0
 
     if (M[1] <= 0.0) {
-        double M0 = 1.0;
+        double M0 = M[0];
         double sigL = 3.0;                              // sigL and mavg should be same as in domaincase
         double mavg = 1.0E-21;
         M[1] = M0 * mavg * exp(0.5 * pow(sigL,2.0));    // give M1 a value based on M0 and lognormal dist.
         sootvar[1] = M[1];
     }
 
-    // CHECK: all remaining moments
-
-    bool zeros = false;                                 // flag for breaking do/while loop
-
-    do {
-
-        if (N <= 2) {                                   // will downselect to 2 moments, but not further
-            break;
-        }
-
-        zeros = false;                                  // reset flag
-
-        for (int i=0; i<N; i++) {
-           if (M[i] <= 0.0) {
-               zeros = true;
-           }
-        }
-
-        if (zeros == true) {                            // if flagged, downselect by two moments
-            N = N - 1;
-        }
+    // CHECK: all remaining moments (realizability, once)
 
-    } while (zeros != 0);                               // keep going until we get no flag
+    vector<double> Mp;
+    N = max(2, min(N, realizableMoments(M, Mp)));       // leading realizable moments, but not fewer than 2
 
     M.resize(N);                                        // resize M based on downselected N
 
@@ -24,17 +24,26 @@ class soot_MOMIC : virtual public soot {
 
     private:
 
+        vector<double>  Mgrid;          ///< fractional moments M_p, p = -1/2, -1/3, ..., on a 1/6 grid (see setFracMoments)
+
     //////////////////// MEMBER FUNCTIONS /////////////////
 
     public:
 
         virtual void setSrc();
+        virtual soot *clone() const { return new soot_MOMIC(*this); }
+
+    protected:
+
+        virtual double getModelCost(const vector<double> &M);
 
     private:
 
         double  lagrangeInterp(double x_i, vector<double> x, vector<double> y);
         double  MOMIC(double p, vector<double> M);
-        double  f_grid(int x, int y, vector<double> M);
+        void    setFracMoments();
+        double  Mfrac(const double &p) { return Mgrid[lround(6.0*p)+3]; }    ///< MOMIC(p, sootvar) from Mgrid
+        double  f_grid(int x, int y);
         double  beta(int p, int q, int ipt);
         double  getCoag(int r);
         void    downselectIfNeeded(int &N);
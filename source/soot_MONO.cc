@@ -15,6 +15,9 @@
 
 void soot_MONO::setSrc() {
 
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
     double &M0    = sootvar[0];    //todo issue some checks here like enforcesootmom
     double &M1    = sootvar[1];
 
@@ -34,26 +37,18 @@ void soot_MONO::setSrc() {
     double Jnuc  = getNucleationRate(absc, wts);         // #/m3*s
     double Kgrw  = getGrowthRate(M0, M1);                // kg/m2*s
     double Koxi  = getOxidationRate(M0, M1);             // kg/m2*s
-    double Coag  = getCoagulationRate(absc[0], absc[0]);
+    double Coag  = splitCoag ? 0.0 : getCoagulationRate(absc[0], absc[0]);
 
     //--------- nucleation terms
 
     double N0 = Jnuc;                                    // #/m3*s
     double N1 = Jnuc*Cmin*MW_c/Na;                       // kg/m3*s
 
-    //---------- PAH condensation terms
-
-    double Cnd0 = 0.0;
-    double Cnd1 = 0.0;
-
-    if(nucleation_mech=="PAH")                           // condense PAH if nucleate PAH
-        Cnd1 = DIMER*m_dimer*getCoagulationRate(m_dimer, absc[0])*wts[0];
-
     //--------- growth terms
 
     double Am2m3 = 0.0;                                  // m^2_soot / m^3_total
     if(M0 > 0.0)
-        Am2m3 = M_PI * pow(abs(6/(M_PI*rhoSoot)*M1/M0),2.0/3.0) * abs(M0);    // m^2_soot / m^3_total = pi*di^2*M0
+        Am2m3 = M_PI * sootMath::pow23(abs(6/(M_PI*rhoSoot)*M1/M0)) * abs(M0);    // m^2_soot / m^3_total = pi*di^2*M0
 
     double G0 = 0.0;                                     // zero by definition, #/m3*s
     double G1 = Kgrw*Am2m3;                              // kg/m3*s
@@ -63,6 +58,15 @@ void soot_MONO::setSrc() {
     double X0 = 0.0;                                     // zero by definition, #/m3*s
     double X1 = -Koxi*Am2m3;                             // kg/m3*s
 
+    //---------- PAH condensation terms
+
+    double Cnd0 = 0.0;
+    double Cnd1 = 0.0;
+
+    double dom1 = max(abs(N1), max(abs(G1), abs(X1)));
+    if(nucleation_mech=="PAH" && !negligible(m_dimer*wdotD_cnd, dom1, nSkip_cnd))   // condense PAH if nucleate PAH
+        Cnd1 = DIMER*m_dimer*getCoagulationRate(m_dimer, absc[0])*wts[0];
+
     ////--------- coagulation terms
 
     double C0 = -0.5*Coag*wts[0]*wts[0];                 // #/m3*s
@@ -76,5 +80,43 @@ void soot_MONO::setSrc() {
     //---------- compute gas source terms
 
     set_gasSootSources(N1, Cnd1, G1, X1);
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Advances sootvar over dt for coagulation only (see soot::advanceCoagulation).
+ *
+ *      dM0/dt = -0.5*beta(m)*M0^2 with m = M1/M0 and M1 constant.
+ *      In u = 1/M0 this is du/dt = 0.5*beta(M1*u), so for a frozen beta
+ *          M0(dt) = M0/(1 + 0.5*beta*M0*dt),
+ *      which is exact and bounded for any dt. For the self-consistent update
+ *      beta is evaluated at the midpoint u of the step and the step is redone
+ *      (fixed point; beta ~ m^(1/6) in the free-molecular limit, so this
+ *      converges quickly for any dt).
+ *
+ *      @param dt      /input  time step (s)
+ *      @param nIter   /input  number of midpoint updates of beta (0 = frozen)
+ */
+
+void soot_MONO::advanceCoagulation(const double &dt, const int &nIter) {
+
+    double &M0 = sootvar[0];
+    double &M1 = sootvar[1];
+
+    if (M0 <= 0.0 || M1 <= 0.0)
+        return;
+
+    double u0   = 1.0/M0;
+    double beta = getCoagulationRate(M1*u0, M1*u0);
+    double u1   = u0 + 0.5*beta*dt;
+
+    for (int it=0; it<nIter; it++) {
+        double um = 0.5*(u0 + u1);                 // midpoint in u = 1/M0
+        beta = getCoagulationRate(M1*um, M1*um);
+        u1   = u0 + 0.5*beta*dt;
+    }
+
+    M0 = 1.0/u1;
 
 }
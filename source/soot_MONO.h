@@ -32,7 +32,12 @@ class soot_MONO : virtual public soot {
     public:
 
         virtual void setSrc();
+        virtual soot *clone() const { return new soot_MONO(*this); }
+        virtual void advanceCoagulation(const double &dt, const int &nIter=2);
 
+    protected:
+
+        virtual double getModelCost(const vector<double> &M) { return nucleation_mech == "PAH" ? 9.0 : 4.0; }
 
     //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
 
@@ -5,8 +5,10 @@
  */
 
 #include "soot_QMOM.h"
+#include "sootKernels.h"
 #include <cstdlib>
 #include <cmath>
+#include <algorithm>
 #include <boost/math/special_functions/binomial.hpp>
 
 void pdAlg(int nm, int np, vector<double> &mu, vector<double> &wts, vector<double> &absc );
@@ -21,6 +23,9 @@ void adaptiveWheelerAlgorithm(const std::vector<double>& moments, std::vector<do
 
 void soot_QMOM::setSrc() {
 
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
     //domn->domc->enforceSootMom();
 
     vector<double> &M = sootvar;
@@ -33,9 +38,30 @@ void soot_QMOM::setSrc() {
         if(absc[i] < 0.0) absc[i] = 0.0;
     }
 
+    setNodeSrc(M[0], M[1]);                         // src and gasSootSources from wts, absc
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setNodeSrc function
+ *
+ *      Sets src (moment sources) and gasSootSources from the quadrature in
+ *      wts and absc, for all nsvar moments. Shared by QMOM (nodes from the
+ *      moment inversion) and DQMOM (nodes transported directly).
+ *
+ *      @param M0   /input  number density (#/m3) for the growth and oxidation rates
+ *      @param M1   /input  soot mass (kg/m3) for the growth and oxidation rates
+ */
+
+void soot_QMOM::setNodeSrc(const double &M0, const double &M1) {
+
+    setFracMoments();                                       // Mfrac[k] = M_(k-1/3), all at once
+    setParticleProps(absc);                                 // per-node coagulation properties
+
     double Jnuc = getNucleationRate(absc, wts);             // #/m3*s
-    double Kgrw = getGrowthRate(M[0], M[1]);                // kg/m2*s
-    double Koxi = getOxidationRate(M[0], M[1]);             // kg/m2*s
+    double Kgrw = getGrowthRate(M0, M1);                    // kg/m2*s
+    double Koxi = getOxidationRate(M0, M1);                 // kg/m2*s
 
     //---------- nucleation terms
 
@@ -44,40 +70,83 @@ void soot_QMOM::setSrc() {
     for (int k=0; k<nsvar; k++)
         Mnuc[k] = pow(m_nuc,k) * Jnuc;                      // Nr = m_min^r * Jnuc
 
-    //---------- PAH condensation terms
-
-    vector<double> Mcnd(nsvar,0.0);                             // initialize to 0.0
-    if (nucleation_mech == "PAH") {                             // condense PAH if nucleate PAH
-        for (int k=1; k<nsvar; k++) {                           // Mcnd[0] = 0.0 by definition
-            for (int ii=0; ii<absc.size(); ii++)
-                Mcnd[k] += getCoagulationRate(m_dimer, absc[ii])*pow(absc[ii],k-1)*wts[ii];
-            Mcnd[k] *= DIMER*m_dimer*k;
-        }
-    }
-
     //---------- growth terms
 
     vector<double> Mgrw(nsvar,0.0);                           // growth source terms for moments
-    double Acoef = M_PI*pow(abs(6.0/M_PI/rhoSoot),2.0/3.0);   // Acoef = kmol^2/3 / kg^2/3
+    double Acoef = M_PI*sootMath::pow23(abs(6.0/M_PI/rhoSoot));   // Acoef = kmol^2/3 / kg^2/3
     for (int k=1; k<nsvar; k++)                               // Mgrw[0] = 0.0 by definition
-        Mgrw[k] = Kgrw * Acoef * k * Mk(k-1.0/3.0);           // kg^k/m3*s
+        Mgrw[k] = Kgrw * Acoef * k * Mfrac[k];                // kg^k/m3*s
 
     //---------- oxidation terms
 
     vector<double> Moxi(nsvar,0.0);
     for (int k=1; k<nsvar; k++)                               // Moxi[0] = 0.0 by definition
-        Moxi[k] = -Koxi * Acoef * k * Mk(k-1.0/3.0);           // kg^k/m3*s
+        Moxi[k] = -Koxi * Acoef * k * Mfrac[k];               // kg^k/m3*s
+
+    //---------- PAH condensation terms
+
+    vector<double> Mcnd(nsvar,0.0);                             // initialize to 0.0
+    double dom1 = max(abs(Mnuc[1]), max(abs(Mgrw[1]), abs(Moxi[1])));
+    if (nucleation_mech == "PAH" && !negligible(m_dimer*wdotD_cnd, dom1, nSkip_cnd)) {   // condense PAH if nucleate PAH
+        for (int k=1; k<nsvar; k++) {                           // Mcnd[0] = 0.0 by definition
+            for (int ii=0; ii<absc.size(); ii++)
+                Mcnd[k] += getCoagulationRate_pp(ipp_dimer, ii)*pow(absc[ii],k-1)*wts[ii];
+            Mcnd[k] *= DIMER*m_dimer*k;
+        }
+    }
 
     //---------- coagulation terms
 
+    int n = absc.size();
+    vector<double> beta(n*n);                                 // pair kernels, computed once for all k
+    int mech = sootKernels::coagMech(coagulation_mech);
+    if (!useCoagRegimes && skipTol == 0.0 && mech >= 0) {    // all pairs at once (vectorized, see sootKernels)
+        sootKernels::pairKernels(mech, n, &pp_m[0], &pp_rm[0], &pp_Dp[0], &pp_CcDp[0], &pp_D[0], &pp_g[0],
+                                 pp_kT, mu, rhoSoot, eps_c, &beta[0]);
+        nCoagPairs += n*(n+1)/2;
+    }
+    else {
+        //---------- diagonal pairs, and the largest of their terms in each moment (dom)
+        // Coagulation terms of a moment all have the same sign, so dom[k] <= |Mcoa[k]|.
+
+        vector<double> dom(nsvar, 0.0);
+        for(int ii=0; ii<n; ii++) {
+            nCoagPairs++;
+            beta[ii*n+ii] = getCoagulationRate_pp(ii, ii);
+            for(int k=0; k<nsvar; k++)
+                if (k != 1)
+                    dom[k] = max(dom[k], beta[ii*n+ii]*wts[ii]*wts[ii] * (k==0 ? 0.5 : pow(absc[ii],k)*(pow(2,k-1)-1)));
+        }
+
+        //---------- off-diagonal pairs: skipped if an upper bound of their term in every
+        // moment, beta_bound*w_i*w_j*(a_i+a_j)^k, is at most skipTol*dom[k]
+
+        for(int ii=1; ii<n; ii++)
+            for(int j=0; j<ii; j++) {
+                nCoagPairs++;
+                bool skip = skipTol > 0.0;
+                if (skip) {
+                    double est = coagulationRateBound_pp(ii, j)*abs(wts[ii]*wts[j]);
+                    double s   = absc[ii] + absc[j];
+                    double sk  = 1.0;                             // (a_i+a_j)^k
+                    for(int k=0; skip && k<nsvar; k++, sk*=s)
+                        if (k != 1)
+                            skip = est*sk <= skipTol*dom[k];
+                }
+                if (skip)
+                    nSkip_coagPairs++;
+                beta[ii*n+j] = skip ? 0.0 : getCoagulationRate_pp(ii, j);
+            }
+    }
+
     vector<double> Mcoa(nsvar,0.0);                           // coagulation source terms: initialize to zero!
     for(int k=0; k<nsvar; k++) {
         if(k==1) continue;
-        for(int ii=1; ii<absc.size(); ii++)        // off-diagonal terms (looping half of them) with *2 incorporated
+        for(int ii=1; ii<n; ii++)                  // off-diagonal terms (looping half of them) with *2 incorporated
             for(int j=0; j<ii; j++)
-                Mcoa[k] += getCoagulationRate(absc[ii], absc[j])*wts[ii]*wts[j]* (k==0 ? -1.0 : (pow(absc[ii]+absc[j],k))-pow(absc[ii],k)-pow(absc[j],k) );
-        for(int ii=0; ii<absc.size(); ii++)              // diagonal terms
-            Mcoa[k] += getCoagulationRate(absc[ii], absc[ii])*wts[ii]*wts[ii]* (k==0 ? -0.5 : pow(absc[ii],k)*(pow(2,k-1)-1) );        //(pow(absc[ii]+absc[ii],k))-2.0*pow(absc[ii],k) );
+                Mcoa[k] += beta[ii*n+j]*wts[ii]*wts[j]* (k==0 ? -1.0 : (pow(absc[ii]+absc[j],k))-pow(absc[ii],k)-pow(absc[j],k) );
+        for(int ii=0; ii<n; ii++)                        // diagonal terms
+            Mcoa[k] += beta[ii*n+ii]*wts[ii]*wts[ii]* (k==0 ? -0.5 : pow(absc[ii],k)*(pow(2,k-1)-1) );        //(pow(absc[ii]+absc[ii],k))-2.0*pow(absc[ii],k) );
     }
 
     //---------- combinine to make source terms
@@ -92,22 +161,53 @@ void soot_QMOM::setSrc() {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-/*! Mk function
- *      Calculates fractional moments from weights and abscissas.
- *      @param exp  \input  fractional moment to compute, corresponds to exponent
+/*! getModelCost function
+ *
+ *      Model part of soot::getPredictedCost: moment inversion and the pair
+ *      kernels scale as nsvar^2, condensation of the PAH dimer as the number
+ *      of nodes; the realizability check (realizableMoments) as nsvar^2.
+ *      Non-realizable sets are projected and inverted once at a lower
+ *      order, so they cost no more than realizable ones.
+ *
+ *      @param M   /input soot variables of the cell
+ */
+
+double soot_QMOM::getModelCost(const vector<double> &M) {
+
+    double c = 8.0 + 2.0*nsvar*nsvar;
+    if (nucleation_mech == "PAH")
+        c += 1.5*nsvar;
+
+    return c;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! setFracMoments function
+ *      Calculates all fractional moments listed in fracExps from the current
+ *      weights and abscissas; results go in Mfrac.
+ *      log(absc) is taken once per node, then the whole (exponent x node)
+ *      matrix is passed through exp in one contiguous loop (vectorizable;
+ *      sootKernels::fracMoments).
+ *      Nodes with zero weight or abscissa (e.g., left by downselection)
+ *      contribute nothing.
+ *
+ *      Call getWtsAbs first.
  */
 
-double soot_QMOM::Mk(double exp) {
+void soot_QMOM::setFracMoments() {
 
-    double Mk = 0;
+    int nn = absc.size();
+    int ne = fracExps.size();
 
-    for(int k=0; k<nsvar/2; k++) {
-        if (wts[k] == 0 || absc[k] == 0)
-            return 0;
-        else
-            Mk += wts[k] * pow(absc[k],exp);
+    vector<double> w(nn);
+    for(int k=0; k<nn; k++) {
+        bool empty = (wts[k] == 0 || absc[k] == 0);
+        w[k]       = empty ? 0.0 : wts[k];
+        logAbsc[k] = empty ? 0.0 : sootMath::log(absc[k]);
     }
-    return Mk;
+
+    sootKernels::fracMoments(ne, nn, &fracExps[0], &logAbsc[0], &w[0], &expWork[0], &Mfrac[0]);
 
 }
 
@@ -123,21 +223,44 @@ double soot_QMOM::Mk(double exp) {
  *
  *      Notes:
  *      - Use wheeler over pdalg whenever possible.
- *      - wts and abs DO NOT change size; if we downselect to a smaller number
- *      of moments, the extra values are set at and stay zero
+ *      - wts and abs DO NOT change size; they are zeroed on entry, so if we
+ *      downselect to a smaller number of moments the extra values are zero
  *      - using w_temp and a_temp means we don't have to resize wts and absc,
  *      which is more convenient when wts and absc are used to reconstitute
  *      moment source terms.
+ *      - the moment set is checked once (realizableMoments) and inverted at
+ *      its highest realizable even order; the downselection loop is only a
+ *      fallback for round-off (negative wts/absc from a marginal set).
+ *      - with scaleMoments (see set_moment_scaling), the inversion runs on
+ *      M_k/(N_ref*m_ref^k), which are O(1); wts and absc are returned in
+ *      #/m3 and kg either way.
  */
 
 void soot_QMOM::getWtsAbs(vector<double> M, vector<double> &wts, vector<double> &absc) {
 
-    for (int k=0; k<nsvar; k++) {                  // if any moments are zero, return with zero wts and absc
-        if (M[k] <= 0.0)
-            return;
+    for (int k=0; k<wts.size(); k++) {             // nodes not set below stay zero (not the last cell's)
+        wts[k]  = 0.0;
+        absc[k] = 0.0;
+    }
+
+    if (M[0] <= 0.0 || M[1] <= 0.0)                // no particles: return with zero wts and absc
+        return;
+
+    vector<double> Mp;                             // highest realizable even order: one inversion
+    int N = realizableMoments(M, Mp);
+    N -= N%2;
+
+    double Nsc = 1.0;                              // units of the inversion: wts*Nsc in #/m3, absc*msc in kg
+    double msc = 1.0;
+    if (scaleMoments) {
+        setMomentScales(M);
+        Nsc = N_ref;
+        msc = m_ref;
+        double s = Nsc;
+        for (int k=0; k<nsvar; k++, s*=msc)        // M_k/(N_ref*m_ref^k)
+            M[k] /= s;
     }
 
-    int N = nsvar;                                 // local nsvar
     bool negs = false;                             // flag for downselecting if there are negative wts/abs
 
     vector<double> w_temp(N/2,0.0);
@@ -153,8 +276,8 @@ void soot_QMOM::getWtsAbs(vector<double> M, vector<double> &wts, vector<double>
         }
 
         if (N == 2) {                              // in 2 moment case, return monodisperse output
-           wts[0]  = M[0];
-           absc[0] = M[1]/M[0];
+           wts[0]  = M[0]*Nsc;
+           absc[0] = M[1]/M[0]*msc;
            return;
         }
 
@@ -162,7 +285,7 @@ void soot_QMOM::getWtsAbs(vector<double> M, vector<double> &wts, vector<double>
         wheeler(M, N/2, w_temp, a_temp);           // wheeler algorithm
 
         for (int k=0; k<N/2; k++) {
-            if (w_temp[k] < 0.0 || a_temp[k] < 0.0 || a_temp[k] > 1.0)
+            if (w_temp[k] < 0.0 || a_temp[k] < 0.0 || a_temp[k]*msc > 1.0)
                 negs = true;
         }
 
@@ -175,8 +298,8 @@ void soot_QMOM::getWtsAbs(vector<double> M, vector<double> &wts, vector<double>
     } while (negs == true);                        // end of downselection loop
 
     for (int k = 0; k < w_temp.size(); k++) {      // assign temporary variables to output
-        wts[k]  = w_temp[k];
-        absc[k] = a_temp[k];
+        wts[k]  = w_temp[k]*Nsc;
+        absc[k] = a_temp[k]*msc;
     }
 
 }
@@ -22,20 +22,29 @@ class soot_QMOM : virtual public soot {
 
     //////////////////// DATA MEMBERS //////////////////////
 
-    private:
+    protected:
 
         vector<double>        wts;        ///< weights from inversion algorithm
         vector<double>        absc;       ///< abscissas from inversion algoritm
 
+        vector<double>        fracExps;   ///< exponents of the fractional moments used in the source terms
+        vector<double>        Mfrac;      ///< fractional moments for each exponent in fracExps
+        vector<double>        logAbsc;    ///< log of the abscissas (workspace)
+        vector<double>        expWork;    ///< exponent x node matrix for the fractional moments (workspace)
+
     //////////////////// MEMBER FUNCTIONS /////////////////
 
     public:
 
         virtual void setSrc();
+        virtual soot *clone() const { return new soot_QMOM(*this); }
+
+    protected:
 
-    private:
+        virtual double getModelCost(const vector<double> &M);
 
-        double  Mk(double exp);
+        void    setNodeSrc(const double &M0, const double &M1);
+        void    setFracMoments();
         void    getWtsAbs(vector<double> M, vector<double> &wts, vector<double> &abs);
 
     //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
@@ -58,6 +67,13 @@ class soot_QMOM : virtual public soot {
 
             wts.resize(nsvar/2);
             absc.resize(nsvar/2);
+
+            fracExps.resize(nsvar);
+            for(int k=0; k<nsvar; k++)
+                fracExps[k] = k-1.0/3.0;            // used by growth and oxidation
+            Mfrac.resize(nsvar);
+            logAbsc.resize(nsvar/2);
+            expWork.resize(nsvar*(nsvar/2));
         }
 
         virtual ~soot_QMOM(){}
@@ -41,6 +41,9 @@ vector<double> dv_soot_SECT::getDivision(double mass, double num, vector<double>
 
 void soot_SECT::setSrc() {
 
+    if (srcFromCache())                               // unchanged inputs: see set_src_cache
+        return;
+
     
     
     vector<double> &wts = sootvar;    // wts: # in section
@@ -63,6 +66,8 @@ void soot_SECT::setSrc() {
 
 
 
+    setParticleProps(absc);                              // per-section coagulation properties
+
     //--------- chemical soot rates
     
     double Jnuc  = getNucleationRate(absc, wts);         // #/m3*s
@@ -79,7 +84,7 @@ void soot_SECT::setSrc() {
     vector<double> Coag(nsvar);
     for (int i = 0; i < nsvar; i++) {
         for (int j = 0; j < nsvar; j++) {
-            double leaving = 0.5 * getCoagulationRate(absc[i],absc[j]) * wts[i]*wts[j];
+            double leaving = 0.5 * getCoagulationRate_pp(i,j) * wts[i]*wts[j];
             Coag[i] = Coag[i] - leaving;
             Coag[j] = Coag[j] - leaving;
             vector<double> divided = getDivision((sections[i] + sections[j]), leaving);
@@ -102,7 +107,7 @@ void soot_SECT::setSrc() {
     if(nucleation_mech=="PAH")  {
         // condense PAH if nucleate PAH
         for (int i = 0; i < nsvar; i++) {
-            Cnd0[i] = DIMER*m_dimer*getCoagulationRate(m_dimer, absc[i])*wts[i];
+            Cnd0[i] = DIMER*m_dimer*getCoagulationRate_pp(ipp_dimer, i)*wts[i];
             Cnd_tot += Cnd0[i]*absc[i];
         }
     }                 
@@ -112,7 +117,7 @@ void soot_SECT::setSrc() {
     vector<double> Am2m3(nsvar);                                  // m^2_soot / m^3_total
     for(int i = 0; i < nsvar; i++) {
         if(wts[i] > 0.0) {
-            Am2m3[i] = M_PI * pow(abs(6/(M_PI*rhoSoot)*sections[i]),2.0/3.0) * abs(wts[i]);    // m^2_soot / m^3_total = pi*di^2*wts
+            Am2m3[i] = M_PI * sootMath::pow23(abs(6/(M_PI*rhoSoot)*sections[i])) * abs(wts[i]);    // m^2_soot / m^3_total = pi*di^2*wts
     	}   
         else {
             Am2m3[i] = 0;
@@ -178,5 +183,35 @@ void soot_SECT::setSrc() {
         
   //  }
     set_gasSootSources(N_tot, Cnd_tot, G_tot, X_tot);
+    saveSrcCache();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Sets src and gasSootSources for a cell with no particles (see
+ *  soot::setSrc_nucOnly): all nucleation goes into the smallest section.
+ */
+
+void soot_SECT::setSrc_nucOnly() {
+
+    double Jnuc = getNucleationRate();                   // #/m3*s
+
+    src.assign(nsvar, 0.0);
+    src[0] = Jnuc / rho;
+
+    set_gasSootSources(Jnuc*Cmin*MW_c/Na, 0.0, 0.0, 0.0);
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! Returns the total particle number density (sum of the sections).
+ */
+
+double soot_SECT::getNumberDensity(const vector<double> &M) {
+
+    double N = 0.0;
+    for(int i = 0; i < M.size(); i++)
+        N += M[i];
+    return N;
 
 }
@@ -32,6 +32,12 @@ class soot_SECT : virtual public soot {
     public:
 
         virtual void setSrc();
+        virtual soot *clone() const { return new soot_SECT(*this); }
+
+    protected:
+
+        virtual void   setSrc_nucOnly();
+        virtual double getNumberDensity(const vector<double> &M);
     
     private:
         vector<double> getDivision(double mass, double num);
@@ -0,0 +1,126 @@
+/**
+ * @file table1D.cc
+ * Source file for class table1D
+ * @author Victoria B. Lansinger
+ */
+
+#include "table1D.h"
+#include "tableCache.h"
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+////////////////////////////////////////////////////////////////////////////////
+/*! init function
+ *
+ *      Tabulates f on a uniform grid on [p_xlo, p_xhi]. Starting from nmin
+ *      points, the grid is refined (doubled) until the relative error of the
+ *      interpolant, checked at the quarter points of every interval, is at
+ *      most relTol or nmax is reached. Returns the error achieved (also
+ *      stored in err).
+ *
+ *      The error of a cubic interpolant scales as h^4*f'''', so for the
+ *      smooth (Arrhenius-type) functions tabulated here the quarter-point
+ *      check bounds the error between the check points to well within the
+ *      next refinement level.
+ *
+ *      @param f        \input  function to tabulate
+ *      @param p_xlo    \input  lower end of the table
+ *      @param p_xhi    \input  upper end of the table
+ *      @param relTol   \input  relative error tolerance
+ *      @param nmin     \input  starting number of points (>= 4)
+ *      @param nmax     \input  largest number of points
+ */
+
+double table1D::init(const function<double(double)> &f, const double &p_xlo, const double &p_xhi,
+                     const double &relTol, const int &nmin, const int &nmax) {
+
+    xlo = p_xlo;
+    xhi = p_xhi;
+    n   = max(nmin, 4);
+
+    while (true) {
+
+        double dx = (xhi-xlo)/(n-1);
+        rdx = 1.0/dx;
+        y.resize(n);
+        for (int i=0; i<n; i++)
+            y[i] = f(xlo + i*dx);
+        yp = &y[0];
+
+        err = 0.0;
+        for (int i=0; i<n-1; i++) {
+            for (int q=1; q<4; q++) {
+                double x  = xlo + (i + 0.25*q)*dx;
+                double fx = f(x);
+                if (fx != 0.0)
+                    err = max(err, abs((*this)(x) - fx)/abs(fx));
+            }
+        }
+
+        if (err <= relTol || 2*n-1 > nmax)
+            break;
+        n = 2*n-1;                            // halve the spacing, keep the nodes
+    }
+
+    return err;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! initCached function
+ *
+ *      As init, but the table is loaded from the tableCache if present (no
+ *      copy: the table reads the mapped file) and otherwise built and saved.
+ *      The cache key is key plus the table range and refinement settings;
+ *      key must describe f completely (e.g., its coefficients) and carry
+ *      the version of the code that evaluates f, bumped when that code
+ *      changes, so stale tables are never loaded.
+ *      Cached data: xlo, xhi, n, err, then the n table values.
+ *
+ *      @param name     \input  table name (cache file prefix)
+ *      @param key      \input  description of f
+ *      @param f        \input  function to tabulate
+ *      @param p_xlo    \input  lower end of the table
+ *      @param p_xhi    \input  upper end of the table
+ *      @param relTol   \input  relative error tolerance
+ *      @param nmin     \input  starting number of points (>= 4)
+ *      @param nmax     \input  largest number of points
+ */
+
+double table1D::initCached(const string &name, const string &key,
+                           const function<double(double)> &f, const double &p_xlo, const double &p_xhi,
+                           const double &relTol, const int &nmin, const int &nmax) {
+
+    ostringstream ss;
+    ss.precision(17);
+    ss << key << ";table1D.v" << version << ";xlo=" << p_xlo << ";xhi=" << p_xhi << ";relTol=" << relTol
+       << ";nmin=" << nmin << ";nmax=" << nmax;
+    string fullKey = ss.str();
+
+    long int nData;
+    const double *d = tableCache::load(name, fullKey, nData);
+    if (d && nData > 4 && nData == 4 + (long int)d[2]) {
+        xlo = d[0];
+        xhi = d[1];
+        n   = (int)d[2];
+        err = d[3];
+        rdx = 1.0/((xhi-xlo)/(n-1));
+        y.clear();
+        yp  = d+4;
+        return err;
+    }
+
+    init(f, p_xlo, p_xhi, relTol, nmin, nmax);
+
+    vector<double> data(4+n);
+    data[0] = xlo;
+    data[1] = xhi;
+    data[2] = n;
+    data[3] = err;
+    for (int i=0; i<n; i++)
+        data[4+i] = y[i];
+    tableCache::save(name, fullKey, data);
+
+    return err;
+}
@@ -0,0 +1,87 @@
+/**
+ * @file table1D.h
+ * Header file for class table1D
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing a uniform 1-D table of a smooth function with local
+ *  cubic (4-point Lagrange) interpolation. The number of points is chosen
+ *  at init to meet a relative error tolerance. With initCached, the table
+ *  is taken from (or stored in) the tableCache and then uses the mapped
+ *  file data directly.
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class table1D {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        double                  xlo;            ///< lower end of the table
+        double                  xhi;            ///< upper end of the table
+        int                     n;              ///< number of table points (0 = not built)
+        double                  err;            ///< max relative interpolation error (checked at init)
+        static const int        version = 1;    ///< in the initCached key: bump when init or the cached layout changes
+
+    private:
+
+        double                  rdx;            ///< 1/(grid spacing)
+        vector<double>          y;              ///< tabulated function values (if built here)
+        const double           *yp;             ///< table values: &y[0] or mapped cache data
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        double init(const function<double(double)> &f, const double &p_xlo, const double &p_xhi,
+                    const double &relTol, const int &nmin=64, const int &nmax=65536);
+        double initCached(const string &name, const string &key,
+                          const function<double(double)> &f, const double &p_xlo, const double &p_xhi,
+                          const double &relTol, const int &nmin=64, const int &nmax=65536);
+
+        bool   inRange(const double &x) const { return x >= xlo && x <= xhi; }
+
+        ////////////////////////////////////////////////////////////////////////
+        /*! Interpolated value at x; call only for inRange(x).
+         */
+
+        double operator()(const double &x) const {
+            double s = (x-xlo)*rdx;
+            int    i = (int)s;
+            i = i < 1 ? 1 : (i > n-3 ? n-3 : i);
+            double t  = s - i;
+            double tm = t - 1.0;
+            double tp = t + 1.0;
+            double t2 = t - 2.0;
+            return (t*tm*t2*(-1.0/6.0))*yp[i-1] + (tp*tm*t2*0.5)*yp[i] +
+                   (tp*t*t2*(-0.5))*yp[i+1] + (tp*t*tm*(1.0/6.0))*yp[i+2];
+        }
+
+    //////////////////// CONSTRUCTOR FUNCTIONS /////////////////
+
+    public:
+
+        table1D() : xlo(0), xhi(0), n(0), err(0), rdx(0), yp(0) {}
+
+        table1D(const table1D &t) : xlo(t.xlo), xhi(t.xhi), n(t.n), err(t.err), rdx(t.rdx), y(t.y),
+                                    yp(t.y.empty() ? t.yp : &y[0]) {}
+
+        table1D &operator=(const table1D &t) {
+            xlo = t.xlo;  xhi = t.xhi;  n = t.n;  err = t.err;  rdx = t.rdx;
+            y   = t.y;
+            yp  = t.y.empty() ? t.yp : &y[0];
+            return *this;
+        }
+
+};
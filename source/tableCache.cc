@@ -0,0 +1,156 @@
+/**
+ * @file tableCache.cc
+ * Source file for class tableCache
+ * @author Victoria B. Lansinger
+ */
+
+#include "tableCache.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+string   tableCache::dir   = "";
+long int tableCache::nLoad = 0;
+long int tableCache::nSave = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+/*! hash function
+ *
+ *      Returns the 64-bit FNV-1a hash of key.
+ *
+ *      @param key   /input  key string
+ */
+
+unsigned long long tableCache::hash(const string &key) {
+
+    unsigned long long h = 14695981039346656037ULL;
+    for (int i=0; i<key.size(); i++) {
+        h ^= (unsigned char)key[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! fileName function
+ *
+ *      Returns the cache file of a table: dir/name_<hash of key>.tbl
+ *
+ *      @param name  /input  table name
+ *      @param key   /input  key string
+ */
+
+string tableCache::fileName(const string &name, const string &key) {
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", hash(key));
+    return dir + "/" + name + "_" + hex + ".tbl";
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! load function
+ *
+ *      Maps the cached table for key, if there is one. Returns a pointer to
+ *      its data (nData doubles, valid until the process exits), or 0 if
+ *      caching is off or the file is missing, of another version, or for
+ *      another key.
+ *
+ *      @param name   /input  table name
+ *      @param key    /input  key string
+ *      @param nData  /output number of doubles in the table
+ */
+
+const double *tableCache::load(const string &name, const string &key, long int &nData) {
+
+    nData = 0;
+    if (dir.empty())
+        return 0;
+
+    string fname = fileName(name, key);
+    int fd = ::open(fname.c_str(), O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat sb;
+    if (fstat(fd, &sb) != 0 || sb.st_size < 24) {
+        ::close(fd);
+        return 0;
+    }
+    size_t size = sb.st_size;
+    void  *map  = mmap(0, size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return 0;
+
+    //---------- check the header
+
+    const char *p = (const char*)map;
+    int      ver, keyLen;
+    long int n;
+    memcpy(&ver,    p+8,  sizeof(int));
+    memcpy(&keyLen, p+12, sizeof(int));
+    memcpy(&n,      p+16, sizeof(long int));
+    long int hdr = 24 + keyLen;
+    hdr += (8 - hdr%8)%8;
+
+    if (memcmp(p, "SOOTTBC1", 8) != 0 || ver != version || keyLen != key.size() ||
+        hdr + n*sizeof(double) != size || key.compare(0, keyLen, p+24, keyLen) != 0) {
+        munmap(map, size);
+        return 0;
+    }
+
+    nData = n;
+    nLoad++;
+    return (const double*)(p + hdr);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+/*! save function
+ *
+ *      Writes a table to the cache (no-op if caching is off). A write
+ *      failure only prints a warning: the table is then rebuilt next time.
+ *
+ *      @param name   /input  table name
+ *      @param key    /input  key string
+ *      @param data   /input  table data
+ */
+
+void tableCache::save(const string &name, const string &key, const vector<double> &data) {
+
+    if (dir.empty())
+        return;
+
+    string fname = fileName(name, key);
+    ostringstream tmp;
+    tmp << fname << ".tmp." << getpid();
+
+    ofstream ofile(tmp.str().c_str(), ios::binary);
+    if (!ofile) {
+        cout << endl << "WARNING: tableCache: cannot write " << tmp.str() << endl;
+        return;
+    }
+
+    int      ival;
+    long int n = data.size();
+    ofile.write("SOOTTBC1", 8);
+    ival = version;         ofile.write((char*)&ival, sizeof(int));
+    ival = key.size();      ofile.write((char*)&ival, sizeof(int));
+    ofile.write((char*)&n, sizeof(long int));
+    ofile.write(key.c_str(), key.size());
+    char pad[8] = {0};
+    ofile.write(pad, (8 - (24+key.size())%8)%8);
+    ofile.write((char*)&data[0], n*sizeof(double));
+    ofile.close();
+
+    if (!ofile || rename(tmp.str().c_str(), fname.c_str()) != 0) {
+        cout << endl << "WARNING: tableCache: cannot write " << fname << endl;
+        remove(tmp.str().c_str());
+        return;
+    }
+    nSave++;
+}
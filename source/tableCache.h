@@ -0,0 +1,61 @@
+/**
+ * @file tableCache.h
+ * Header file for class tableCache
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/** Class implementing a persistent on-disk cache of precomputed tables
+ *  (rate factor tables, kernel tables, coagulation integral tables).
+ *
+ *  Each table is stored in file dir/name_<hash>.tbl, where hash is the
+ *  64-bit FNV-1a hash of a key string describing everything the table
+ *  depends on. The file header repeats the full key, so a hash collision or
+ *  a file of an older format version is treated as a miss. A changed key
+ *  gives a new file name, so the table is regenerated automatically. Keys
+ *  include a version of the code that builds the table (e.g.,
+ *  soot::rateTableVersion), bumped whenever that code changes.
+ *
+ *  Files are mapped read-only and shared: all processes on a node that load
+ *  the same table use the same physical pages. Mappings are kept until the
+ *  process exits. Files are written to a temporary name and renamed, so a
+ *  process never maps a partly written file.
+ *
+ *  File layout (native byte order): magic "SOOTTBC1", int version,
+ *  int key length, long nData, key, padding to 8 bytes, nData doubles.
+ *
+ *  Caching is off while dir is empty (the default).
+ *
+ *  @author Victoria B. Lansinger
+ */
+
+class tableCache {
+
+    //////////////////// DATA MEMBERS //////////////////////
+
+    public:
+
+        static string           dir;                    ///< cache directory ("" = no caching)
+        static const int        version = 1;            ///< file format version
+
+        static long int         nLoad;                  ///< tables loaded from the cache
+        static long int         nSave;                  ///< tables written to the cache
+
+    //////////////////// MEMBER FUNCTIONS /////////////////
+
+    public:
+
+        static const double *load(const string &name, const string &key, long int &nData);
+        static void          save(const string &name, const string &key, const vector<double> &data);
+
+        static unsigned long long hash(const string &key);
+        static string        fileName(const string &name, const string &key);
+
+};